@@ -1,5 +1,6 @@
 ﻿#pragma once
 #include "prographics/prographics_export.h"
+#include "prographics/core/graphics/streaming_buffer.h"
 #include <QOpenGLBuffer>
 #include <QOpenGLFunctions>
 #include <QOpenGLShaderProgram>
@@ -24,6 +25,11 @@ namespace ProGraphics {
 
     ~BaseGLWidget() override;
 
+    /**
+     * @brief 本控件最近一次 paintGL 中 StreamingBuffer 的上传统计
+     */
+    StreamingBuffer::FrameStats lastFrameStats() const { return m_lastFrameStats; }
+
   protected:
     // OpenGL 基础函数
     void initializeGL() override;
@@ -41,5 +47,8 @@ namespace ProGraphics {
     QOpenGLShaderProgram *m_program;
     QOpenGLVertexArrayObject m_vao;
     QElapsedTimer m_timer;
+
+  private:
+    StreamingBuffer::FrameStats m_lastFrameStats;
   };
 } // namespace ProGraphics
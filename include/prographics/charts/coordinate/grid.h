@@ -1,6 +1,7 @@
 ﻿#pragma once
 #include "prographics/core/graphics/primitive2d.h"
 #include <QMatrix4x4>
+#include <array>
 #include <memory>
 
 namespace ProGraphics {
@@ -62,33 +63,54 @@ namespace ProGraphics {
     const Config &config() const { return m_config; }
 
   private:
+    /**
+     * @brief 一组网格线及其在批处理中的图元序号
+     *
+     * 线数变化属于结构变化，需要重建批处理；其余变化只记录在 changed 中，
+     * 渲染时原地改写这些线在批处理暂存区中的顶点。
+     */
+    struct LineSet {
+      std::vector<std::shared_ptr<Line2D> > lines;
+      std::vector<size_t> items; ///< 每条线在批处理中的序号
+      std::vector<size_t> changed; ///< 几何、颜色或可见性变化、尚未写入批处理的线
+    };
+
     void updateGrids();
 
     void updateBatch();
 
-    void generateGridLines(std::vector<std::shared_ptr<Line2D> > &lines,
+    void updateChangedLines();
+
+    std::array<LineSet *, 6> lineSets();
+
+    void generateGridLines(LineSet &lines,
                            const QVector3D &planeNormal,
                            const PlaneConfig &planeConfig);
 
-    void generateSineWave(std::vector<std::shared_ptr<Line2D> > &lines,
+    void generateSineWave(LineSet &lines,
                           const QVector3D &planeNormal,
                           const SineWaveConfig &config,
                           float size);
 
+    void placeLine(LineSet &lines, size_t index, const QVector3D &start, const QVector3D &end,
+                   const QVector4D &color, float lineWidth, bool visible);
+
+    void truncateLines(LineSet &lines, size_t count);
+
     Config m_config;
     // XY平面网格线
-    std::vector<std::shared_ptr<Line2D> > m_xyGridLines;
+    LineSet m_xyGridLines;
     // XZ平面网格线
-    std::vector<std::shared_ptr<Line2D> > m_xzGridLines;
+    LineSet m_xzGridLines;
     // YZ平面网格线
-    std::vector<std::shared_ptr<Line2D> > m_yzGridLines;
+    LineSet m_yzGridLines;
 
-    std::vector<std::shared_ptr<Line2D> > m_xySineWaveLines;
-    std::vector<std::shared_ptr<Line2D> > m_xzSineWaveLines;
-    std::vector<std::shared_ptr<Line2D> > m_yzSineWaveLines;
+    LineSet m_xySineWaveLines;
+    LineSet m_xzSineWaveLines;
+    LineSet m_yzSineWaveLines;
 
     std::unique_ptr<Primitive2DBatch> m_batchRenderer;
-    bool m_batchDirty = true;
+    bool m_batchDirty = true; ///< 线数变化，需要 begin() 重建批处理
     bool m_initialized = false;
   };
 } // namespace ProGraphics
@@ -1,7 +1,13 @@
 ﻿#pragma once
 
 #include "prographics/charts/coordinate/coordinate2d.h"
+#include "prographics/core/graphics/heatmap2d.h"
+#include "prographics/utils/aligned_buffer.h"
+#include "prographics/utils/simd_kernels.h"
+#include "prographics/utils/spsc_cycle_queue.h"
 #include "prographics/utils/utils.h"
+#include <atomic>
+#include <span>
 
 namespace ProGraphics {
     /**
@@ -10,11 +16,18 @@ namespace ProGraphics {
     struct PRPDConstants {
         static constexpr float GL_AXIS_LENGTH = 5.0f; ///< OpenGL 坐标轴长度
         static constexpr float POINT_SIZE = 8.0f; ///< 点渲染大小
-        static constexpr int PHASE_POINTS = 200; ///< 相位采样点数
+        static constexpr int PHASE_POINTS = 200; ///< 默认相位采样点数
         static constexpr int MAX_CYCLES = 500; ///< 最大周期缓存数
         static constexpr float PHASE_MAX = 360.0f; ///< 相位最大值
         static constexpr float PHASE_MIN = 0.0f; ///< 相位最小值
-        static constexpr int AMPLITUDE_BINS = 100; ///< 幅值划分格子数
+        static constexpr int AMPLITUDE_BINS = 100; ///< 默认幅值划分格子数
+        static constexpr int MAX_AMPLITUDE_BINS = 4096; ///< 幅值格子数上限
+        static constexpr int QUEUE_CAPACITY = 1024; ///< 跨线程待处理周期队列默认容量
+        static constexpr size_t PARALLEL_REBUILD_GRAIN = 65536; ///< 并行重建时每个线程至少处理的样本数
+        static constexpr float DECAY_HALF_LIFE_DEFAULT = 100.0f; ///< 指数衰减模式默认半衰期（周期数）
+        static constexpr float DECAY_RENORMALIZE_GAIN = 1e30f; ///< 指数衰减增益超过该值时重新归一化
+        static constexpr float DECAY_VISIBLE_RATIO = 0.005f; ///< 指数衰减模式下低于最大值该比例的格子不显示
+        static constexpr int DECAY_COLOR_LEVELS = 64; ///< 指数衰减模式点渲染的颜色量化级数
     };
 
     /**
@@ -36,6 +49,31 @@ namespace ProGraphics {
             Adaptive ///< 自适应模式 - 在初始范围基础上智能调整
         };
 
+        /**
+         * @brief 渲染模式
+         */
+        enum class RenderMode {
+            Points, ///< 点模式 - 按频次分批实例化绘制点
+            Heatmap ///< 热力图模式 - 频次表作为纹理上传，单次绘制整张图
+        };
+
+        /**
+         * @brief 原始周期历史的存储格式
+         */
+        enum class HistoryFormat {
+            Float32, ///< 32 位浮点，无损
+            Int16, ///< 16 位定点，每周期独立的最小值与步长，误差不超过 (周期最大值-最小值)/131070
+            LogUInt8 ///< 8 位 μ-law 对数量化（μ=255），每周期独立缩放，越接近周期峰值精度越高；非有限样本的处理与误差上界见 cycle_codec.h
+        };
+
+        /**
+         * @brief 累积模式
+         */
+        enum class AccumulationMode {
+            SlidingWindow, ///< 滑动窗口 - 保留最近 MAX_CYCLES 个原始周期，精确计数
+            ExponentialDecay ///< 指数衰减 - 按半衰期衰减的加权计数，不保留原始周期
+        };
+
         explicit PRPDChart(QWidget *parent = nullptr);
 
         ~PRPDChart() override;
@@ -127,14 +165,126 @@ namespace ProGraphics {
          */
         bool isHardLimitsEnabled() const;
 
+        // ==================== 渲染模式 API ====================
+
+        /**
+         * @brief 设置渲染模式
+         *
+         * 热力图模式下不再维护按频次分组的点批次，
+         * 只记录发生变化的相位行并在绘制前增量上传纹理。
+         */
+        void setRenderMode(RenderMode mode);
+
+        /**
+         * @brief 获取当前渲染模式
+         */
+        RenderMode getRenderMode() const { return m_renderMode; }
+
+        // ==================== 累积模式 API ====================
+
+        /**
+         * @brief 设置累积模式
+         *
+         * 指数衰减模式下每个新周期的权重相对旧数据按半衰期递增，
+         * 衰减通过全局增益实现，每周期 O(1)，增益过大时整体重新归一化；
+         * 不保留原始周期，内存与窗口长度无关。量程变化时按格子中心重新映射。
+         * 切换模式会清空已有统计。
+         */
+        void setAccumulationMode(AccumulationMode mode);
+
+        /**
+         * @brief 获取当前累积模式
+         */
+        AccumulationMode getAccumulationMode() const { return m_accumulationMode; }
+
+        /**
+         * @brief 设置指数衰减半衰期
+         * @param cycles 半衰期（周期数），必须大于 0
+         */
+        void setDecayHalfLife(float cycles);
+
+        /**
+         * @brief 获取指数衰减半衰期（周期数）
+         */
+        float getDecayHalfLife() const { return m_decayHalfLife; }
+
+        // ==================== 历史存储格式 API ====================
+
+        /**
+         * @brief 设置滑动窗口中原始周期的存储格式
+         *
+         * 压缩格式可将历史内存降为 1/2（Int16）或 1/4（LogUInt8），
+         * 量程变化重建时按周期即时解码。切换格式时已有历史会重新编码。
+         */
+        void setHistoryFormat(HistoryFormat format);
+
+        /**
+         * @brief 获取原始周期的存储格式
+         */
+        HistoryFormat getHistoryFormat() const { return m_cycleBuffer.format; }
+
         // ==================== 数据接口 ====================
 
         /**
          * @brief 添加一个周期的放电数据
-         * @param cycleData 幅值数组，长度必须等于 PHASE_POINTS
+         * @param cycleData 幅值数组，长度必须等于当前相位采样点数
          */
         void addCycleData(const std::vector<float> &cycleData);
 
+        /**
+         * @brief 批量添加连续的多个周期数据
+         *
+         * 整块数据只做一次量程更新、一次重绘请求，逐周期分格统计。
+         * @param data 第一个周期的首地址
+         * @param cycleCount 周期数
+         * @param stride 相邻周期首地址之间的元素个数，必须不小于相位采样点数
+         */
+        void addCycles(const float *data, size_t cycleCount, size_t stride);
+
+        /**
+         * @brief 批量添加紧密排列的多个周期数据
+         * @param data 周期数据块，长度必须是相位采样点数的整数倍
+         */
+        void addCycles(std::span<const float> data);
+
+        /**
+         * @brief 从任意线程提交一个周期数据（线程安全，不阻塞；Block 策略最多等待 blockTimeout）
+         *
+         * 数据写入无锁单生产者/单消费者队列，GUI 线程通过排队的调用一次性取出并统计，
+         * 不依赖绘制，控件隐藏时队列同样会被取空；每帧绘制前还会再取一次。
+         * 同一时刻只能有一个生产者线程调用。
+         * @param data 周期数据
+         * @param count 元素个数，必须等于相位采样点数
+         * @return 是否进入队列
+         */
+        bool enqueueCycle(const float *data, size_t count);
+
+        bool enqueueCycle(const std::vector<float> &cycleData) {
+            return enqueueCycle(cycleData.data(), cycleData.size());
+        }
+
+        /**
+         * @brief 设置跨线程队列容量（仅 GUI 线程调用）
+         *
+         * 清空队列中未处理的周期。可与 enqueueCycle 并发：重新分配期间提交的周期被拒绝（返回 false）。
+         */
+        void setQueueCapacity(size_t cycles);
+
+        /**
+         * @brief 设置跨线程队列满时的处理策略，默认 DropOldest
+         */
+        void setOverflowPolicy(OverflowPolicy policy) { m_pendingCycles.setOverflowPolicy(policy); }
+
+        /**
+         * @brief 设置 Block 策略下单次提交的最长等待时间，默认 100 ms，超时的周期计入 droppedCycleCount()
+         */
+        void setBlockTimeout(std::chrono::microseconds timeout) { m_pendingCycles.setBlockTimeout(timeout); }
+
+        /**
+         * @brief 获取跨线程队列累计丢弃的周期数
+         */
+        uint64_t droppedCycleCount() const { return m_pendingCycles.droppedCount(); }
+
         /**
          * @brief 设置相位范围
          */
@@ -142,17 +292,35 @@ namespace ProGraphics {
 
         /**
          * @brief 设置相位采样点数
+         *
+         * 重新分配统计网格，并将已缓存的周期按新点数重采样（区间取最大值）后重新统计。
+         * 跨线程队列按新点数重新分配，尚未处理的周期被丢弃；之后 enqueueCycle 只接受新长度的周期。
          */
         void setPhasePoint(int phasePoint);
 
+        /**
+         * @brief 获取相位采样点数
+         */
+        int getPhasePoint() const { return m_phasePoints; }
+
+        /**
+         * @brief 设置幅值划分格子数
+         *
+         * 重新分配统计网格，并根据已缓存的周期重新统计。
+         * @param bins 格子数，范围 [1, MAX_AMPLITUDE_BINS]
+         */
+        void setAmplitudeBins(int bins);
+
+        /**
+         * @brief 获取幅值划分格子数
+         */
+        int getAmplitudeBins() const { return m_amplitudeBins; }
+
         /**
          * @brief 重置所有数据
          */
         void resetData() {
-            m_cycleBuffer.data.clear();
-            m_cycleBuffer.binIndices.clear();
-            m_cycleBuffer.currentIndex = 0;
-            m_cycleBuffer.isFull = false;
+            m_cycleBuffer.clear();
             m_renderBatchMap.clear();
             clearFrequencyTable();
 
@@ -167,6 +335,7 @@ namespace ProGraphics {
             }
 
             updateAxisTicks(displayMin, displayMax);
+            resetDecayGrid();
             update();
         }
 
@@ -233,31 +402,81 @@ namespace ProGraphics {
         struct RenderBatch {
             std::unordered_map<std::pair<int, int>, Transform2D, PairHash> pointMap;
             int frequency;
-            mutable std::vector<Transform2D> transforms;
+            mutable std::vector<Primitive2DInstance> instances;
             mutable bool needsRebuild = true;
 
-            void rebuildTransforms(const QVector4D &color) const {
+            void rebuildInstances(const QVector4D &color) const {
                 if (!needsRebuild)
                     return;
-                transforms.clear();
-                transforms.reserve(pointMap.size());
+                instances.clear();
+                instances.reserve(pointMap.size());
                 for (const auto &[_, transform]: pointMap) {
                     Transform2D t = transform;
                     t.color = color;
-                    transforms.push_back(t);
+                    instances.push_back(Primitive2DInstance::fromTransform(t));
                 }
                 needsRebuild = false;
             }
         };
 
         using BinIndex = uint16_t;
-        using FrequencyTable = std::array<std::array<int, PRPDConstants::AMPLITUDE_BINS>, PRPDConstants::PHASE_POINTS>;
+        /// 频次统计网格：行优先连续存储，[phaseIdx * m_amplitudeBins + binIdx]
+        using FrequencyTable = AlignedBuffer<int>;
 
+        /**
+         * @brief 原始周期环形缓冲
+         *
+         * 样本与分格结果各占一块连续内存（capacity × phasePoints），
+         * 写满后覆盖最老的周期，稳态写入不分配内存。
+         * 样本按 format 编码存放，压缩格式每个周期附带偏移与缩放两个参数。
+         */
         struct CycleBuffer {
-            std::vector<std::vector<float> > data;
-            std::vector<std::vector<BinIndex> > binIndices;
-            int currentIndex = 0;
-            bool isFull = false;
+            HistoryFormat format = HistoryFormat::Float32;
+            AlignedBuffer<uint8_t> data;
+            AlignedBuffer<BinIndex> binIndices;
+            std::vector<float> offsets; ///< 每周期解码偏移
+            std::vector<float> scales; ///< 每周期解码缩放
+            int capacity = 0;
+            int phasePoints = 0;
+            int count = 0; ///< 已缓存周期数
+            int head = 0; ///< 下一个写入槽位；写满时即最老周期所在槽位
+
+            void allocate(int cycles, int points, HistoryFormat fmt);
+
+            void clear() {
+                count = 0;
+                head  = 0;
+            }
+
+            bool isFull() const { return count == capacity; }
+
+            /// 第 i 旧的周期所在槽位（i = 0 为最老）
+            int slotAt(int i) const { return (head - count + i + capacity) % capacity; }
+
+            size_t sampleBytes() const;
+
+            /// Float32 格式下直接访问样本，其他格式返回 nullptr
+            const float *rawCycle(int slot) const {
+                return format == HistoryFormat::Float32
+                           ? reinterpret_cast<const float *>(data.data()) + static_cast<size_t>(slot) * phasePoints
+                           : nullptr;
+            }
+
+            BinIndex *bins(int slot) { return binIndices.data() + static_cast<size_t>(slot) * phasePoints; }
+
+            /// 编码并写入一个周期
+            void store(int slot, const float *cycle);
+
+            /// 解码周期中 [begin, begin + length) 的样本
+            void load(int slot, int begin, int length, float *out) const;
+
+            /// 推进写指针，返回本次写入的槽位
+            int advance() {
+                const int slot = head;
+                head           = (head + 1) % capacity;
+                count          = std::min(count + 1, capacity);
+                return slot;
+            }
         };
 
         // ==================== 成员变量 ====================
@@ -266,8 +485,15 @@ namespace ProGraphics {
         FrequencyTable m_frequencyTable;
         std::unordered_map<int, RenderBatch> m_renderBatchMap;
         int m_maxFrequency = 0;
+        std::vector<int> m_frequencyHistogram; ///< 频次直方图：[f] = 频次为 f 的格子数，用于 O(1) 维护最大频次
 
         std::unique_ptr<Point2D> m_pointRenderer;
+        std::unique_ptr<Heatmap2D> m_heatmapRenderer;
+
+        RenderMode m_renderMode = RenderMode::Points;
+        int m_heatmapDirtyBegin = 0; ///< 待上传的起始相位行
+        int m_heatmapDirtyEnd = 0; ///< 待上传的结束相位行（不含）
+        std::vector<float> m_heatmapStaging; ///< 纹理上传暂存区，复用避免分配
 
         float m_amplitudeMin = -75.0f;
         float m_amplitudeMax = -30.0f;
@@ -276,6 +502,7 @@ namespace ProGraphics {
         float m_phaseMin = PRPDConstants::PHASE_MIN;
         float m_phaseMax = PRPDConstants::PHASE_MAX;
         int m_phasePoints = PRPDConstants::PHASE_POINTS;
+        int m_amplitudeBins = PRPDConstants::AMPLITUDE_BINS;
 
         DynamicRange m_dynamicRange{0.0f, 50.0f, DynamicRange::DynamicRangeConfig()};
 
@@ -285,9 +512,26 @@ namespace ProGraphics {
         float m_configuredMin = -75.0f;
         float m_configuredMax = -30.0f;
 
+        bool m_rangeDirty = false; ///< 量程或网格尺寸已变化，下一帧绘制前重建频次表
+
+        AccumulationMode m_accumulationMode = AccumulationMode::SlidingWindow;
+        float m_decayHalfLife = PRPDConstants::DECAY_HALF_LIFE_DEFAULT;
+        float m_decayGrowth = 1.0f; ///< 每周期增益增长倍数 2^(1/半衰期)
+        float m_decayGain = 1.0f; ///< 当前全局增益：真实值 = 存储值 / 增益
+        float m_decayMax = 0.0f; ///< 存储值最大值（存储值只增不减，可精确增量维护）
+        AlignedBuffer<float> m_decayGrid; ///< 指数衰减统计网格，布局与频次表相同
+        float m_decayGridMin = 0.0f; ///< 衰减网格分格时使用的量程
+        float m_decayGridMax = 0.0f;
+        int m_decayGridBins = 0;
+        bool m_decayPointsDirty = false; ///< 点模式批次需要按衰减网格重建
+        std::vector<BinIndex> m_binScratch; ///< 指数衰减模式单周期分格结果暂存区
         bool m_paused = false;      ///< 是否暂停数据更新
         bool m_acceptData = true;  ///< 是否接受新数据
 
+        SpscCycleQueue m_pendingCycles; ///< 跨线程提交的待处理周期
+        std::atomic<bool> m_drainScheduled{false}; ///< 是否已投递重绘请求，保证队列非空时最多一个待处理请求
+        std::vector<float> m_drainStaging; ///< 每帧取出队列数据的暂存区
+
         // ==================== 私有方法 ====================
 
         void updatePointTransformsFromFrequencyTable();
@@ -296,6 +540,71 @@ namespace ProGraphics {
 
         void clearFrequencyTable();
 
+        void resizeFrequencyTable();
+
+        /**
+         * @brief 格子频次加一，同步维护频次直方图与最大频次
+         */
+        void incrementFrequency(int &freq) {
+            if (freq > 0) {
+                --m_frequencyHistogram[freq];
+            }
+            ++freq;
+            if (freq >= static_cast<int>(m_frequencyHistogram.size())) {
+                m_frequencyHistogram.resize(freq + 1, 0);
+            }
+            ++m_frequencyHistogram[freq];
+            m_maxFrequency = std::max(m_maxFrequency, freq);
+        }
+
+        /**
+         * @brief 格子频次减一，同步维护频次直方图与最大频次
+         *
+         * 频次逐一变化，最大频次的格子减一后 max-1 一定存在（或为 0），因此无需扫描。
+         */
+        void decrementFrequency(int &freq) {
+            --m_frequencyHistogram[freq];
+            if (freq == m_maxFrequency && m_frequencyHistogram[freq] == 0) {
+                --m_maxFrequency;
+            }
+            --freq;
+            if (freq > 0) {
+                ++m_frequencyHistogram[freq];
+            }
+        }
+
+        bool updateRangeFromBlock(const float *data, size_t cycleCount, size_t stride);
+
+        void ingestBlock(const float *data, size_t cycleCount, size_t stride);
+
+        void ingestCycle(const float *cycle);
+
+        void accumulateDecayed(const float *cycle);
+
+        void resetDecayGrid();
+
+        void resizeDecayGrid();
+
+        void remapDecayGrid();
+
+        void renormalizeDecayGrid();
+
+        bool isDecayMode() const { return m_accumulationMode == AccumulationMode::ExponentialDecay; }
+
+        void drainPendingCycles();
+
+        int &frequencyAt(int phaseIdx, int binIdx) {
+            return m_frequencyTable[static_cast<size_t>(phaseIdx) * m_amplitudeBins + binIdx];
+        }
+
+        const int *frequencyRow(int phaseIdx) const {
+            return m_frequencyTable.data() + static_cast<size_t>(phaseIdx) * m_amplitudeBins;
+        }
+
+        void markHeatmapRowsDirty(int begin, int end);
+
+        void uploadHeatmapRows();
+
         void removePointFromBatch(int phaseIdx, BinIndex binIdx, int frequency);
 
         void addPointToBatch(int phaseIdx, BinIndex binIdx, int frequency);
@@ -304,7 +613,12 @@ namespace ProGraphics {
 
         float mapAmplitudeToGL(float amplitude) const;
 
-        BinIndex getAmplitudeBinIndex(float amplitude) const;
+        /**
+         * @brief 当前用于分格的显示范围 {最小值, 最大值}
+         */
+        std::pair<float, float> displayRange() const;
+
+        void rebuildFrequencyHistogram();
 
         float getBinCenterAmplitude(BinIndex binIndex) const;
 
@@ -1,10 +1,18 @@
 ﻿#pragma once
 
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QThread>
 #include <QWaitCondition>
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <span>
 #include "prographics/charts/coordinate/coordinate3d.h"
-#include "prographics/core/graphics/primitive2d.h"
+#include "prographics/charts/prps/prps_renderer.h"
+#include "prographics/charts/prps/prps_surface_renderer.h"
+#include "prographics/utils/aligned_buffer.h"
+#include "prographics/utils/spsc_cycle_queue.h"
 #include "prographics/utils/utils.h"
 
 namespace ProGraphics {
@@ -13,24 +21,34 @@ namespace ProGraphics {
    */
   struct PRPSConstants {
     static constexpr int PHASE_POINTS = 200; ///< 相位采样点数
-    static constexpr int CYCLES_PER_FRAME = 50; ///< 每帧周期数
+    static constexpr int CYCLES_PER_FRAME = 50; ///< 每个线组最多聚合的周期数
     static constexpr float GL_AXIS_LENGTH = 6.0f; ///< OpenGL 坐标轴长度
     static constexpr float MAX_Z_POSITION = 6.0f; ///< 最大 Z 轴位置
     static constexpr float MIN_Z_POSITION = 0.0f; ///< 最小 Z 轴位置
     static constexpr float PHASE_MAX = 360.0f;
     static constexpr float PHASE_MIN = 0.0f;
-    static constexpr size_t MAX_LINE_GROUPS = 80; ///< 最大线组数量
+    static constexpr size_t MAX_LINE_GROUPS = 80; ///< 最大线组数量（同时也是 GPU 实例环的槽位数）
+    static constexpr size_t HISTORY_DEPTH_DEFAULT = MAX_LINE_GROUPS; ///< 默认 CPU 历史深度（线组数）
     /** 默认渲染竖线数（小于每周期采样点数时在相位方向分桶并取桶内峰值） */
     static constexpr int DISPLAY_LINE_COUNT_DEFAULT = 50;
+    static constexpr int QUEUE_CAPACITY = 256; ///< 跨线程待处理周期队列默认容量
+    static constexpr float SCROLL_STEP = 0.1f; ///< 每个动画间隔滚动的 Z 距离
+    static constexpr float FADE_DEPTH = 2.0f; ///< Z 小于该值时开始淡出
+    /** 动画时间基准的重置周期（秒），保证着色器中的单精度时间不丢失精度 */
+    static constexpr double TIME_REBASE_SECONDS = 3600.0;
   };
 
   /**
    * @brief 动画更新线程
+   *
+   * @deprecated PRPSChart 已改由 frameSwapped 驱动动画，不再使用本类。
+   * 保留只为兼容直接使用它的外部代码，将在下一个主版本中移除。
    */
   class UpdateThread : public QThread {
     Q_OBJECT
 
   public:
+    Q_DECL_DEPRECATED_X("PRPSChart drives its animation from frameSwapped; UpdateThread is no longer used")
     explicit UpdateThread(QObject *parent = nullptr);
 
     ~UpdateThread() override;
@@ -60,6 +78,9 @@ namespace ProGraphics {
    *
    * 用于显示局部放电信号的三维时序演变。
    * 支持三种量程模式：固定、自动、自适应。
+   *
+   * 滚动动画由 frameSwapped 驱动（跟随显示器刷新），
+   * 没有线组或已暂停时不再请求重绘，有新数据或恢复时重新开始。
    */
   class PRPSChart : public Coordinate3D {
     Q_OBJECT
@@ -74,6 +95,31 @@ namespace ProGraphics {
       Adaptive ///< 自适应模式 - 在初始范围基础上智能调整
     };
 
+    /**
+     * @brief 多周期聚合方式（每个线组由连续 K 个周期归约而成）
+     */
+    enum class AggregationMode {
+      MaxHold, ///< 峰值保持 - 每个相位取 K 个周期中的最大幅值
+      Mean, ///< 平均 - 每个相位取 K 个周期的平均幅值
+      PulseCount ///< 脉冲计数 - 每个相位统计 K 个周期中超过阈值的次数，Y 轴显示 0..K
+    };
+
+    /**
+     * @brief 竖线样式（分桶降采样时每个桶的表示方式）
+     */
+    enum class LineStyle {
+      Peak, ///< 峰值线 - 从底面画到桶内最大幅值
+      Envelope ///< 包络条 - 从桶内最小幅值画到最大幅值
+    };
+
+    /**
+     * @brief 渲染方式
+     */
+    enum class RenderMode {
+      Lines, ///< 竖线 - 每个桶一根竖线
+      Surface ///< 曲面 - 相位 x 时间网格上的高度场，高度取桶峰值
+    };
+
     explicit PRPSChart(QWidget *parent = nullptr);
 
     ~PRPSChart() override;
@@ -174,9 +220,93 @@ namespace ProGraphics {
     void addCycleData(const std::vector<float> &cycleData);
 
     /**
-     * @brief 设置阈值
+     * @brief 批量添加连续的多个周期数据
+     *
+     * 整块数据只做一次量程更新，每个周期生成一个线组；
+     * 超过 MAX_LINE_GROUPS 的较早周期只参与量程统计。
+     * @param data 第一个周期的首地址
+     * @param cycleCount 周期数
+     * @param stride 相邻周期首地址之间的元素个数，必须不小于相位采样点数
      */
-    void setThreshold(float threshold) { m_threshold = threshold; }
+    void addCycles(const float *data, size_t cycleCount, size_t stride);
+
+    /**
+     * @brief 批量添加紧密排列的多个周期数据
+     * @param data 周期数据块，长度必须是相位采样点数的整数倍
+     */
+    void addCycles(std::span<const float> data);
+
+    /**
+     * @brief 从任意线程提交一个周期数据（线程安全，不阻塞；Block 策略最多等待 blockTimeout）
+     *
+     * 数据写入无锁单生产者/单消费者队列，GUI 线程通过排队的调用一次性取出并生成线组，
+     * 不依赖绘制，控件隐藏时队列同样会被取空；每帧绘制前还会再取一次，
+     * 生产者线程不接触任何 OpenGL 状态。同一时刻只能有一个生产者线程调用。
+     * @param data 周期数据
+     * @param count 元素个数，必须等于相位采样点数
+     * @return 是否进入队列
+     */
+    bool enqueueCycle(const float *data, size_t count);
+
+    bool enqueueCycle(const std::vector<float> &cycleData) {
+      return enqueueCycle(cycleData.data(), cycleData.size());
+    }
+
+    /**
+     * @brief 设置跨线程队列容量（仅 GUI 线程调用）
+     *
+     * 清空队列中未处理的周期。可与 enqueueCycle 并发：重新分配期间提交的周期被拒绝（返回 false）。
+     */
+    void setQueueCapacity(size_t cycles);
+
+    /**
+     * @brief 设置跨线程队列满时的处理策略，默认 DropOldest
+     */
+    void setOverflowPolicy(OverflowPolicy policy) { m_pendingCycles.setOverflowPolicy(policy); }
+
+    /**
+     * @brief 设置 Block 策略下单次提交的最长等待时间，默认 100 ms，超时的周期计入 droppedCycleCount()
+     */
+    void setBlockTimeout(std::chrono::microseconds timeout) { m_pendingCycles.setBlockTimeout(timeout); }
+
+    /**
+     * @brief 获取跨线程队列累计丢弃的周期数
+     */
+    uint64_t droppedCycleCount() const { return m_pendingCycles.droppedCount(); }
+
+    /**
+     * @brief 噪声底自适应门限配置
+     *
+     * 每个相位以流式分位数估计跟踪噪声底，幅值不超过 噪声底 + margin 的采样不生成竖线。
+     */
+    struct NoiseFloorConfig {
+      bool enabled = false; ///< 是否启用
+      float quantile = 0.9f; ///< 跟踪的分位数（0..1）
+      float margin = 3.0f; ///< 门限高出噪声底的余量（幅值单位）
+      float step = 0.1f; ///< 每个线组的估计更新步长（幅值单位）
+    };
+
+    /**
+     * @brief 设置幅值阈值，低于阈值的采样不生成竖线（默认不过滤）
+     *
+     * 门限在生成实例前以向量化预处理应用，被滤除的采样不占用实例和上传带宽。
+     * 修改后按历史重建现有线组。
+     */
+    void setThreshold(float threshold);
+
+    float getThreshold() const { return m_threshold; }
+
+    /**
+     * @brief 设置噪声底自适应门限，与阈值同时生效
+     */
+    void setNoiseFloorConfig(const NoiseFloorConfig &config);
+
+    const NoiseFloorConfig &getNoiseFloorConfig() const { return m_noiseFloorConfig; }
+
+    /**
+     * @brief 各相位当前的噪声底估计（未启用或尚无数据时为空）
+     */
+    const std::vector<float> &noiseFloor() const { return m_noiseFloor; }
 
     /**
      * @brief 设置相位范围
@@ -185,9 +315,14 @@ namespace ProGraphics {
 
     /**
      * @brief 设置相位采样点数
+     *
+     * 清空历史，跨线程队列按新点数重新分配，尚未处理的周期被丢弃；
+     * 之后 enqueueCycle 只接受新长度的周期。点数不大于 0 或与当前相同时不做任何操作。
      */
     void setPhasePoint(int phasePoint);
 
+    int getPhasePoint() const { return m_phasePoints; }
+
     /**
      * @brief 设置每周期绘制的竖线数量（分桶峰值降采样）
      *
@@ -200,13 +335,89 @@ namespace ProGraphics {
      */
     int displayLineCount() const { return m_displayLineCount; }
 
+    /**
+     * @brief 设置竖线样式，默认 Peak；修改后按历史重建现有线组
+     *
+     * 逐点绘制时每个桶只有一个采样，Envelope 与 Peak 的区别仅在于竖线下端从该采样幅值开始。
+     */
+    void setLineStyle(LineStyle style);
+
+    LineStyle getLineStyle() const { return m_lineStyle; }
+
+    /**
+     * @brief 设置渲染方式，默认 Lines；修改后按历史重建现有线组
+     *
+     * Surface 模式下每个线组只上传一行分桶峰值，整个曲面一次索引三角带绘制完成，
+     * 高相位分辨率时比逐根竖线更易读。曲面模式不区分竖线样式。
+     */
+    void setRenderMode(RenderMode mode);
+
+    RenderMode getRenderMode() const { return m_renderMode; }
+
+    // ==================== 多周期聚合 API ====================
+
+    /**
+     * @brief 设置每个线组聚合的周期数 K（限制在 1..CYCLES_PER_FRAME，默认 1 即不聚合）
+     *
+     * 连续 K 个周期归约为一个线组，历史覆盖的时间随之扩大 K 倍。
+     * 修改后清空已有数据。
+     */
+    void setCyclesPerGroup(int cycles);
+
+    int getCyclesPerGroup() const { return m_cyclesPerGroup; }
+
+    /**
+     * @brief 设置多周期聚合方式，默认 MaxHold；修改后清空已有数据
+     *
+     * PulseCount 模式下幅值大于 max(显示下限, 阈值) 计为一次脉冲。
+     */
+    void setAggregationMode(AggregationMode mode);
+
+    AggregationMode getAggregationMode() const { return m_aggregationMode; }
+
+    // ==================== 历史回看 API ====================
+
+    /**
+     * @brief 设置 CPU 历史深度（线组数，不小于 MAX_LINE_GROUPS），修改后清空数据
+     *
+     * 历史以连续环形缓冲保存每个线组的相位幅值，例如 10000 个线组、200 个相位点约 8 MB。
+     */
+    void setHistoryDepth(size_t groups);
+
+    size_t getHistoryDepth() const { return m_history.capacity; }
+
+    /**
+     * @brief 当前已保存的历史线组数
+     */
+    size_t historySize() const { return m_history.count; }
+
+    /**
+     * @brief 回看历史：显示最新线组之前第 offset 个起、向前共 span 个线组
+     *
+     * 回看期间画面静止，新数据照常进入历史。span 超过 MAX_LINE_GROUPS 时按细节层次合并：
+     * 最近的切片为单个线组，越早的切片覆盖的线组按几何级数增多（取峰值），
+     * GPU 实例数始终不超过 MAX_LINE_GROUPS 个切片。
+     * 视图按设置时的历史位置锚定，不随新数据移动。
+     */
+    void setHistoryView(size_t offset, size_t span);
+
+    /**
+     * @brief 退出历史回看，恢复实时滚动显示
+     */
+    void clearHistoryView();
+
+    bool isHistoryViewActive() const { return m_historyView.active; }
+
     /**
      * @brief 设置动画更新间隔
+     *
+     * 滚动速度为每个间隔 SCROLL_STEP，位置由着色器按实际经过的时间计算，
+     * 与重绘频率无关；实际帧率跟随显示器刷新。
      */
-    void setUpdateInterval(int intervalMs) { m_updateThread.setUpdateInterval(intervalMs); }
+    void setUpdateInterval(int intervalMs);
 
     /**
-     * @brief 重置所有数据（含 PRPS 线图元；需在 OpenGL 上下文中销毁 GPU 资源）
+     * @brief 重置所有数据
      */
     void resetData();
 
@@ -262,27 +473,83 @@ namespace ProGraphics {
     void paintGLObjects() override;
 
   private slots:
+    /**
+     * @brief 每帧交换后推进动画：清理滚出的线组，仍有内容且未暂停时请求下一帧
+     */
     void updatePRPSAnimation();
 
   private:
     // ==================== 内部数据结构 ====================
 
     struct LineGroup {
-      float zPosition = PRPSConstants::MAX_Z_POSITION;
-      bool isActive = true;
-      bool instanceBufferDirty = true;
-      std::vector<float> amplitudes;
-      std::vector<Transform2D> transforms;
-      std::unique_ptr<Line2D> instancedLine;
+      float birth = 0.0f; ///< 诞生时间（相对 m_timeBase 的秒数）
+      int slot = 0; ///< 在渲染器实例环中的槽位
+      bool uploaded = false; ///< 是否已由历史行生成槽位数据并上传
+      uint64_t sequence = 0; ///< 幅值在历史环中的序号
+    };
+
+    /**
+     * @brief 线组幅值的环形历史
+     *
+     * 每行为一个线组（聚合后）的相位幅值，连续存放；写满后覆盖最老的行。
+     * 行按全局递增序号访问，被覆盖的序号返回 nullptr。
+     * 额外保留一行作为聚合中的行，周期直接累积到其中，提交时不再复制。
+     */
+    struct HistoryRing {
+      AlignedBuffer<float> data;
+      size_t capacity = 0;
+      size_t rowSize = 0;
+      size_t count = 0; ///< 已保存行数
+      uint64_t next = 0; ///< 下一行的序号
+
+      void allocate(size_t rows, size_t points);
+
+      void clear() {
+        count = 0;
+        next = 0;
+      }
+
+      /**
+       * @brief 正在聚合的行（序号为 next），不会与任何已保存的行重叠
+       */
+      float *pending() { return data.data() + static_cast<size_t>(next % (capacity + 1)) * rowSize; }
+
+      /**
+       * @brief 提交正在聚合的行
+       * @return 该行的序号
+       */
+      uint64_t commit() {
+        count = std::min(count + 1, capacity);
+        return next++;
+      }
+
+      const float *row(uint64_t sequence) const;
+    };
+
+    /**
+     * @brief 历史回看视图，显示序号 [end - span, end) 的线组
+     */
+    struct HistoryView {
+      bool active = false;
+      bool dirty = false; ///< 需要重建切片并上传
+      uint64_t end = 0;
+      size_t span = 0;
     };
 
     // ==================== 成员变量 ====================
 
-    std::vector<std::vector<float> > m_currentCycles;
-    float m_threshold = 0.1f;
-    std::vector<std::unique_ptr<LineGroup> > m_lineGroups;
-    UpdateThread m_updateThread;
-    float m_prpsAnimationSpeed = 0.1f;
+    float m_threshold = std::numeric_limits<float>::lowest(); ///< 默认不过滤
+    std::vector<LineGroup> m_lineGroups; ///< 存活线组，按诞生顺序排列
+    std::unique_ptr<PRPSRenderer> m_renderer; ///< 所有线组共用的实例环
+    std::unique_ptr<PRPSSurfaceRenderer> m_surfaceRenderer; ///< 曲面模式的高度场环
+    size_t m_nextSlot = 0; ///< 下一个线组使用的槽位序号（对 MAX_LINE_GROUPS 取模）
+    int m_updateIntervalMs = 20;
+    float m_scrollSpeed = PRPSConstants::SCROLL_STEP * 1000.0f / 20.0f; ///< Z 单位/秒
+
+    QElapsedTimer m_clock; ///< 动画时钟，暂停时失效
+    double m_clockOffset = 0.0; ///< 之前各运行段累计的动画时间（秒）
+    double m_timeBase = 0.0; ///< 诞生时间的基准，定期前移
+    bool m_renderClearPending = false; ///< 实例环需要整体清空
 
     DynamicRange m_dynamicRange{-75.0f, -30.0f, DynamicRange::DynamicRangeConfig()};
 
@@ -297,20 +564,110 @@ namespace ProGraphics {
     int m_phasePoints = PRPSConstants::PHASE_POINTS;
     /** 每周期绘制的竖线数；默认分桶峰值，&lt;=0 或 &gt;=m_phasePoints 时逐点绘制 */
     int m_displayLineCount = PRPSConstants::DISPLAY_LINE_COUNT_DEFAULT;
-
+    LineStyle m_lineStyle = LineStyle::Peak;
+    RenderMode m_renderMode = RenderMode::Lines;
+
+    int m_cyclesPerGroup = 1; ///< 每个线组聚合的周期数
+    AggregationMode m_aggregationMode = AggregationMode::MaxHold;
+    int m_aggregatedCycles = 0; ///< 历史环聚合行中已累积的周期数
+
+    NoiseFloorConfig m_noiseFloorConfig;
+    std::vector<float> m_noiseFloor; ///< 各相位噪声底估计，空表示尚未初始化
+    std::vector<float> m_gateScratch; ///< 门限预处理暂存区
+    std::vector<float> m_bucketMin; ///< 分桶最小值
+    std::vector<float> m_bucketMax; ///< 分桶最大值
+    std::vector<uint32_t> m_bucketArgMax; ///< 分桶最大值所在相位，用于查找对应的噪声底
+    std::vector<float> m_bucketFloor; ///< 分桶最大值所在相位的噪声底
+
+    HistoryRing m_history;
+    HistoryView m_historyView;
+    std::vector<float> m_sliceScratch; ///< 历史切片峰值归约暂存区
+    std::vector<PRPSRenderer::LineInstance> m_slotInstances; ///< 槽位上传前的竖线实例暂存区
+
+    bool m_linesDirty = false; ///< 槽位数据的生成方式已变化，下一帧绘制前重新生成并上传所有线组
     bool m_paused = false; ///< 是否暂停动画
     bool m_acceptData = true; ///< 是否接受新数据
 
+    SpscCycleQueue m_pendingCycles; ///< 跨线程提交的待处理周期
+    std::atomic<bool> m_drainScheduled{false}; ///< 是否已投递重绘请求，保证队列非空时最多一个待处理请求
+    std::vector<float> m_drainStaging; ///< 每帧取出队列数据的暂存区
+
     // ==================== 私有方法 ====================
 
-    void processCurrentCycles();
+    bool updateRangeFromBlock(const float *data, size_t cycleCount, size_t stride);
+
+    void ingestBlock(const float *data, size_t cycleCount, size_t stride);
 
+    void appendLineGroup(uint64_t sequence);
+
+    /**
+     * @brief 将一个周期归约进当前聚合线组
+     * @return 是否已满 K 个周期，为 true 时历史环的聚合行为完整的线组幅值
+     */
+    bool aggregateCycle(const float *cycle);
+
+    void resetAggregate();
+
+    /**
+     * @brief 清空线组、历史与聚合状态（不影响量程）
+     */
+    void clearHistory();
+
+    /**
+     * @brief 按细节层次将回看视图归约为至多 MAX_LINE_GROUPS 个切片并写入实例环
+     */
+    void uploadHistoryView();
+
+    void drainPendingCycles();
+
+    /**
+     * @brief 当前动画时间（秒），暂停期间不前进
+     */
+    double animationTime() const;
+
+    /**
+     * @brief 移除已滚出 Z 范围的线组（按诞生顺序从头部移除）
+     */
     void cleanupInactiveGroups();
 
     /**
-     * @brief 由一周期幅值序列生成竖线实例变换（分桶取峰值或全采样）
+     * @brief 动画时间远离基准时前移基准并重新上传所有线组
+     */
+    void rebaseTimeIfNeeded();
+
+    /**
+     * @brief 将一周期幅值序列按显示桶归约并对桶峰值应用门限
+     *
+     * 门限后的峰值写入 m_gateScratch（被滤除为 -inf），Envelope 样式下桶最小值写入 m_bucketMin。
+     * @return 桶数
+     */
+    size_t reduceCycleToBuckets(const float *cycleData);
+
+    /**
+     * @brief 由一周期幅值序列生成竖线实例（全被滤除的桶不生成实例）
+     */
+    void buildLineInstancesFromCycle(const float *cycleData, std::vector<PRPSRenderer::LineInstance> &out);
+
+    /**
+     * @brief 按当前渲染方式由一行幅值生成槽位数据并写入对应的渲染器（仅在 paintGLObjects 中调用）
+     * @param cycleData 一个线组的相位幅值，为 nullptr 时将槽位置空
+     */
+    void uploadSlot(int slot, const float *cycleData, float birth);
+
+    /**
+     * @brief 用一个线组的幅值更新噪声底估计
+     */
+    void updateNoiseFloor(const float *row);
+
+    /**
+     * @brief 每周期实际绘制的竖线数上限
+     */
+    int lineCapacity() const;
+
+    /**
+     * @brief 收集本帧绘制参数（动画时间、相位布局、显示量程）
      */
-    void buildLineTransformsFromCycle(const std::vector<float> &cycleData, std::vector<Transform2D> &out) const;
+    PRPSRenderer::DrawParams drawParams() const;
 
     float mapPhaseToGL(float phase) const;
 
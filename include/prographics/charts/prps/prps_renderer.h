@@ -0,0 +1,131 @@
+﻿#pragma once
+#include <QMatrix4x4>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QVector2D>
+#include <QVector3D>
+#include <memory>
+#include <limits>
+#include <vector>
+
+namespace ProGraphics {
+  /**
+   * @brief PRPS 瀑布图渲染器
+   *
+   * 所有线组共用一个常驻的实例缓冲，按槽位组织成环：
+   * - 每个槽位容纳一个周期的全部竖线（linesPerSlot 个实例）
+   * - 新周期只用 glBufferSubData 覆盖一个槽位
+   * - 整个瀑布图一次实例化绘制完成
+   *
+   * 实例只保存相位序号、原始幅值和诞生时间：
+   * - Z 位置与淡出由当前时间和滚动速度计算，滚动每帧只需更新一次 uniform
+   * - 线高与颜色由显示量程 uniform 计算，量程变化不需要重建或上传实例
+   *
+   * 槽位内只上传实际存在的竖线，每个槽位的有效实例数以 uniform 数组传入，
+   * 超出部分在顶点着色器中剔除。竖线端点由 gl_VertexID 生成，不需要顶点缓冲。
+   */
+  class PRPSRenderer : protected QOpenGLExtraFunctions {
+  public:
+    /**
+     * @brief 单根竖线的实例数据
+     */
+    struct LineInstance {
+      float phaseIndex = 0.0f; ///< 相位序号，GL 坐标 x = (phaseIndex + phaseOffset) * phaseScale
+      float amplitude = 0.0f; ///< 原始幅值
+      float birth = 0.0f; ///< 诞生时间（秒），由 writeSlot 填写
+      float low = -std::numeric_limits<float>::infinity(); ///< 竖线下端幅值，-inf 表示从底面开始
+    };
+
+    /**
+     * @brief 每帧绘制参数
+     */
+    struct DrawParams {
+      float time = 0.0f; ///< 当前动画时间（秒）
+      float speed = 0.0f; ///< 滚动速度（Z 单位/秒）
+      float phaseScale = 1.0f;
+      float phaseOffset = 0.0f;
+      float amplitudeMin = 0.0f; ///< 显示量程下限，幅值不超过该值的竖线不绘制
+      float amplitudeMax = 1.0f; ///< 显示量程上限，超出部分按满高绘制
+      float height = 1.0f; ///< 满量程对应的线高（GL 坐标）
+    };
+
+    PRPSRenderer();
+
+    ~PRPSRenderer();
+
+    /**
+     * @brief 初始化 GPU 资源
+     * 必须在OpenGL上下文中调用
+     * @param slotCount 槽位数（即最多同时显示的线组数）
+     * @param linesPerSlot 每个槽位的竖线数
+     */
+    void initialize(int slotCount, int linesPerSlot);
+
+    /**
+     * @brief 修改每个槽位的竖线数，重新分配实例缓冲（内容清空）
+     */
+    void setLinesPerSlot(int linesPerSlot);
+
+    int slotCount() const { return m_slotCount; }
+    int linesPerSlot() const { return m_linesPerSlot; }
+
+    /**
+     * @brief 覆盖一个槽位的实例数据，只上传 count 个实例
+     * @param birth 该槽位所有实例的诞生时间（秒）
+     */
+    void writeSlot(int slot, const LineInstance *lines, int count, float birth);
+
+    /**
+     * @brief 将所有槽位的有效实例数清零
+     */
+    void clear();
+
+    /**
+     * @brief 设置滚动几何参数
+     * @param startZ 诞生时的 Z 位置
+     * @param endZ Z 小于等于该值时不再绘制
+     * @param fadeDepth Z 小于该值时按 z / fadeDepth 淡出
+     */
+    void setScrollRange(float startZ, float endZ, float fadeDepth);
+
+    /**
+     * @brief 绘制所有槽位
+     */
+    void draw(const QMatrix4x4 &projection, const QMatrix4x4 &view, const DrawParams &params);
+
+    /**
+     * @brief 销毁 GPU 资源
+     */
+    void destroy();
+
+  private:
+    void initializeShader();
+
+    void allocateInstanceBuffer();
+
+    // 链接后解析一次的 uniform 位置，投影与视图矩阵走 CameraBlock
+    struct UniformLocations {
+      int time = -1;
+      int speed = -1;
+      int scroll = -1;
+      int phase = -1;
+      int range = -1;
+      int height = -1;
+      int linesPerSlot = -1;
+      int slotLines = -1;
+    };
+
+    std::unique_ptr<QOpenGLShaderProgram> m_program;
+    UniformLocations m_uniforms;
+    QOpenGLVertexArrayObject m_vao;
+    GLuint m_instanceBuffer = 0;
+    int m_slotCount = 0;
+    int m_linesPerSlot = 0;
+    float m_startZ = 0.0f;
+    float m_endZ = 0.0f;
+    float m_fadeDepth = 0.0f;
+    std::vector<LineInstance> m_staging; ///< 槽位上传暂存区
+    std::vector<GLint> m_slotLines; ///< 每个槽位的有效实例数
+  };
+} // namespace ProGraphics
@@ -0,0 +1,107 @@
+﻿#pragma once
+#include "prographics/charts/prps/prps_renderer.h"
+#include <QMatrix4x4>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <memory>
+#include <vector>
+
+namespace ProGraphics {
+  /**
+   * @brief PRPS 高度场曲面渲染器
+   *
+   * 与 PRPSRenderer 共用槽位环的组织方式，每个槽位保存一个线组的一行分桶峰值：
+   * - 高度存放在 列数 x 槽位数 的单通道浮点纹理中，新线组只用 glTexSubImage2D 覆盖一行
+   * - 网格为静态的 列数 x 槽位数 索引三角带，顶点位置只由 gl_VertexID 推出，不需要顶点缓冲
+   * - 顶点着色器按环头将网格行映射到槽位，从纹理读取高度完成位移
+   * - 整个曲面一次 glDrawElements 绘制完成
+   *
+   * Z 位置、淡出、高度与颜色的计算方式与 PRPSRenderer 相同，绘制参数直接复用 DrawParams。
+   */
+  class PRPSSurfaceRenderer : protected QOpenGLExtraFunctions {
+  public:
+    PRPSSurfaceRenderer();
+
+    ~PRPSSurfaceRenderer();
+
+    /**
+     * @brief 初始化 GPU 资源
+     * 必须在OpenGL上下文中调用
+     * @param slotCount 槽位数（即网格行数）
+     * @param columns 每行的列数（分桶数）
+     */
+    void initialize(int slotCount, int columns);
+
+    /**
+     * @brief 修改列数，重新分配高度纹理与索引缓冲（内容清空）
+     */
+    void setColumns(int columns);
+
+    int slotCount() const { return m_slotCount; }
+    int columns() const { return m_columns; }
+
+    /**
+     * @brief 覆盖一个槽位的高度行
+     * @param heights 各列原始幅值，-inf 表示该列贴底；不足 columns 的部分按 -inf 补齐，count 为 0 时将槽位标记为空
+     * @param birth 该行的诞生时间（秒）
+     */
+    void writeRow(int slot, const float *heights, int count, float birth);
+
+    /**
+     * @brief 将所有槽位标记为空
+     */
+    void clear();
+
+    /**
+     * @brief 设置滚动几何参数，含义同 PRPSRenderer::setScrollRange
+     */
+    void setScrollRange(float startZ, float endZ, float fadeDepth);
+
+    /**
+     * @brief 绘制曲面
+     * @param headSlot 最新一行所在的槽位；其后一个槽位是最旧的行，两者之间不连接
+     */
+    void draw(const QMatrix4x4 &projection, const QMatrix4x4 &view, const PRPSRenderer::DrawParams &params,
+              int headSlot);
+
+    /**
+     * @brief 销毁 GPU 资源
+     */
+    void destroy();
+
+  private:
+    void initializeShader();
+
+    void allocateGrid();
+
+    // 链接后解析一次的 uniform 位置，投影与视图矩阵走 CameraBlock
+    struct UniformLocations {
+      int time = -1;
+      int speed = -1;
+      int scroll = -1;
+      int phase = -1;
+      int range = -1;
+      int height = -1;
+      int columns = -1;
+      int head = -1;
+      int slotValid = -1;
+      int slotBirth = -1;
+    };
+
+    std::unique_ptr<QOpenGLShaderProgram> m_program;
+    UniformLocations m_uniforms;
+    QOpenGLVertexArrayObject m_vao;
+    GLuint m_indexBuffer = 0;
+    GLuint m_heightTexture = 0;
+    GLsizei m_indexCount = 0;
+    int m_slotCount = 0;
+    int m_columns = 0;
+    float m_startZ = 0.0f;
+    float m_endZ = 0.0f;
+    float m_fadeDepth = 0.0f;
+    std::vector<float> m_staging; ///< 行上传暂存区
+    std::vector<GLint> m_slotValid; ///< 每个槽位是否有数据
+    std::vector<float> m_slotBirth; ///< 每个槽位的诞生时间
+  };
+} // namespace ProGraphics
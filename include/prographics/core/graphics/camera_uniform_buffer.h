@@ -0,0 +1,73 @@
+﻿#pragma once
+#include "prographics/prographics_export.h"
+#include <QMatrix4x4>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+
+class QOpenGLContext;
+
+namespace ProGraphics {
+  /**
+   * @brief 共享的相机 uniform 缓冲
+   *
+   * 投影矩阵与视图矩阵放在一个 std140 布局的 uniform 块中，
+   * 所有声明了该块的着色器程序绑定到同一个绑定点：
+   * @code
+   * layout (std140) uniform CameraBlock {
+   *     mat4 projection;
+   *     mat4 view;
+   * };
+   * @endcode
+   * update() 只在矩阵变化时上传，同一帧内的多次绘制只付出一次比较。
+   * 与 GpuBufferAllocator 一样按单例共享，要求使用它的上下文彼此共享资源。
+   */
+  class PROGRAPHICS_EXPORT CameraUniformBuffer : protected QOpenGLExtraFunctions {
+  public:
+    static constexpr GLuint BINDING_POINT = 0;
+    static constexpr const char *BLOCK_NAME = "CameraBlock";
+
+    static CameraUniformBuffer &getInstance() {
+      static CameraUniformBuffer instance;
+      return instance;
+    }
+
+    /**
+     * @brief 将程序中的 CameraBlock 绑定到共享绑定点，程序链接后调用一次
+     */
+    void attach(QOpenGLShaderProgram &program);
+
+    /**
+     * @brief 更新相机矩阵，矩阵未变化时不上传
+     * 必须在OpenGL上下文中调用
+     */
+    void update(const QMatrix4x4 &projection, const QMatrix4x4 &view);
+
+    /**
+     * @brief 删除缓冲
+     */
+    void cleanup();
+
+  private:
+    CameraUniformBuffer() = default;
+
+    ~CameraUniformBuffer();
+
+    CameraUniformBuffer(const CameraUniformBuffer &) = delete;
+
+    CameraUniformBuffer &operator=(const CameraUniformBuffer &) = delete;
+
+    // std140 下 mat4 按列主序占 64 字节，与 QMatrix4x4::constData() 一致
+    struct Block {
+      float projection[16];
+      float view[16];
+    };
+
+    void ensureCreated();
+
+    bool m_initialized = false;
+    GLuint m_buffer = 0;
+    Block m_block{};
+    bool m_blockValid = false; ///< m_block 与 GPU 中的内容一致
+    QOpenGLContext *m_boundContext = nullptr; ///< 绑定点属于上下文状态，切换上下文后需重新绑定
+  };
+} // namespace ProGraphics
@@ -0,0 +1,174 @@
+﻿#pragma once
+#include "prographics/prographics_export.h"
+#include <QOpenGLExtraFunctions>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ProGraphics {
+  /**
+   * @brief GPU 缓冲子分配的句柄
+   *
+   * 句柄是分配表中的下标加代数，不随分配表增长或碎片整理失效；
+   * 释放后代数递增，过期句柄解析为空位置。
+   */
+  struct GpuBufferHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0; ///< 0 表示空句柄
+
+    bool isValid() const { return generation != 0; }
+  };
+
+  /**
+   * @brief 子分配在 GPU 上的实际位置
+   */
+  struct GpuBufferLocation {
+    GLuint buffer = 0; ///< 所在的缓冲对象
+    size_t offset = 0; ///< 字节偏移
+    size_t size = 0; ///< 有效字节数：申请的大小与写入过的最远位置中的较大者
+    size_t capacity = 0; ///< 块的实际容量（不小于 size）
+  };
+
+  /**
+   * @brief 顶点缓冲子分配器
+   *
+   * 用少量大块缓冲（arena）承载大量小图元的顶点数据：
+   * - 块大小按 2 的幂分级（256 B 起），每级一个空闲链表，分配与释放均为 O(1)
+   * - 空闲链表为空时从当前 arena 顺序切分；arena 剩余空间不足时按级拆入空闲链表后新建 arena
+   * - 超过 arena 大小的申请使用独占缓冲，释放时直接删除
+   * - compact() 将存活块紧密复制到新的 arena 并删除旧 arena，之后 epoch() 递增，
+   *   使用方据此重新设置顶点属性指针
+   * - maintain() 在空闲块积累到一定程度时才整理，由 BaseGLWidget 在每帧绘制后调用
+   *
+   * 与原先的 VertexBufferPool 一样按单例共享，要求使用它的上下文彼此共享资源。
+   */
+  class PROGRAPHICS_EXPORT GpuBufferAllocator : protected QOpenGLExtraFunctions {
+  public:
+    /**
+     * @brief 分配器统计
+     */
+    struct Stats {
+      size_t arenas = 0; ///< 共享 arena 数
+      size_t dedicatedBuffers = 0; ///< 独占缓冲数
+      size_t reservedBytes = 0; ///< 所有缓冲的 GPU 存储总量
+      size_t liveBytes = 0; ///< 存活分配申请的字节数
+      size_t liveAllocations = 0; ///< 存活分配数
+      size_t freeBytes = 0; ///< 空闲链表中块的总容量
+    };
+
+    static GpuBufferAllocator &getInstance() {
+      static GpuBufferAllocator instance;
+      return instance;
+    }
+
+    /**
+     * @brief 分配至少 bytes 字节，必须在OpenGL上下文中调用
+     */
+    GpuBufferHandle allocate(size_t bytes);
+
+    /**
+     * @brief 释放分配，空句柄或过期句柄被忽略
+     */
+    void release(GpuBufferHandle handle);
+
+    /**
+     * @brief 解析句柄，无效句柄返回 buffer 为 0 的位置
+     */
+    GpuBufferLocation location(GpuBufferHandle handle) const;
+
+    /**
+     * @brief 写入分配内 [offset, offset + bytes) 的数据，超出块容量的部分被截断
+     *
+     * 写入范围超过当前有效大小时有效大小随之扩大，碎片整理会完整保留这部分数据。
+     */
+    void upload(GpuBufferHandle handle, const void *data, size_t bytes, size_t offset = 0);
+
+    /**
+     * @brief 碎片整理：把存活块紧密复制到新的 arena
+     * @return 回收的 GPU 存储字节数
+     */
+    size_t compact();
+
+    /**
+     * @brief 维护点：空闲块容量超过共享 arena 总量的一半且不少于一个 arena 时执行 compact()
+     *
+     * 只检查计数，不整理时开销可忽略，适合每帧调用；必须在OpenGL上下文中调用。
+     * @return 回收的 GPU 存储字节数，未整理时为 0
+     */
+    size_t maintain();
+
+    /**
+     * @brief 碎片整理次数；变化表示已有分配的位置可能改变
+     */
+    uint64_t epoch() const { return m_epoch; }
+
+    Stats stats() const;
+
+    /**
+     * @brief 删除所有缓冲，使所有句柄失效
+     */
+    void cleanup();
+
+  private:
+    static constexpr size_t MIN_BLOCK = 256;
+    static constexpr size_t ARENA_SIZE = 1 << 20;
+    static constexpr size_t CLASS_COUNT = 13; ///< MIN_BLOCK << (CLASS_COUNT - 1) == ARENA_SIZE
+    static constexpr uint8_t DEDICATED = 0xff; ///< 独占缓冲的级别标记
+
+    struct Arena {
+      GLuint buffer = 0;
+      size_t size = 0;
+      size_t used = 0; ///< 顺序切分的位置
+      bool dedicated = false; ///< 只承载一个超大分配
+    };
+
+    struct Block {
+      uint32_t arena = 0;
+      size_t offset = 0;
+    };
+
+    struct Slot {
+      Block block;
+      size_t size = 0;
+      uint8_t sizeClass = 0;
+      uint32_t generation = 1;
+      bool live = false;
+    };
+
+    GpuBufferAllocator() = default;
+
+    ~GpuBufferAllocator();
+
+    GpuBufferAllocator(const GpuBufferAllocator &) = delete;
+
+    GpuBufferAllocator &operator=(const GpuBufferAllocator &) = delete;
+
+    static uint8_t sizeClassFor(size_t bytes);
+
+    static size_t classSize(uint8_t sizeClass) { return MIN_BLOCK << sizeClass; }
+
+    uint32_t createArena(size_t size, bool dedicated);
+
+    void destroyArena(uint32_t arena);
+
+    /**
+     * @brief 从顺序切分的 arena 中取一个块，剩余不足时先把尾部拆入空闲链表
+     */
+    Block carve(uint8_t sizeClass);
+
+    void retireTail(uint32_t arena);
+
+    const Slot *resolve(GpuBufferHandle handle) const;
+
+    bool m_initialized = false;
+    std::vector<Arena> m_arenas; ///< buffer 为 0 的项是已删除 arena 的空位
+    std::vector<uint32_t> m_freeArenaIndices;
+    uint32_t m_currentArena = UINT32_MAX; ///< 正在顺序切分的 arena
+    std::array<std::vector<Block>, CLASS_COUNT> m_freeBlocks;
+    std::vector<Slot> m_slots;
+    std::vector<uint32_t> m_freeSlots;
+    size_t m_freeBytes = 0; ///< m_freeBlocks 中块容量之和
+    uint64_t m_epoch = 0;
+  };
+} // namespace ProGraphics
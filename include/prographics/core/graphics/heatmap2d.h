@@ -0,0 +1,97 @@
+﻿#pragma once
+#include <QMatrix4x4>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLBuffer>
+#include <QVector2D>
+#include <memory>
+
+namespace ProGraphics {
+  /**
+   * @brief 2D热力图图元
+   *
+   * 将一个行优先的二维数值网格作为单通道浮点纹理上传，
+   * 用一个四边形覆盖目标区域，在片段着色器中完成颜色映射：
+   * - 一次绘制调用完成整张图
+   * - 只上传发生变化的行
+   * - 数值不超过下限（默认 0）的格子不绘制（透明）
+   *
+   * 网格的行对应 X 方向（如相位），列对应 Y 方向（如幅值格子）。
+   */
+  class Heatmap2D : protected QOpenGLExtraFunctions {
+  public:
+    Heatmap2D();
+
+    ~Heatmap2D();
+
+    /**
+     * @brief 初始化 GPU 资源
+     * 必须在OpenGL上下文中调用
+     */
+    void initialize();
+
+    /**
+     * @brief 设置网格尺寸，尺寸变化时重新分配纹理（内容清零）
+     * @param rows 行数（X 方向格子数）
+     * @param cols 列数（Y 方向格子数）
+     */
+    void resize(int rows, int cols);
+
+    /**
+     * @brief 更新连续若干行的数据
+     * @param firstRow 起始行
+     * @param rowCount 行数
+     * @param data 行优先数据，长度为 rowCount * cols
+     */
+    void updateRows(int firstRow, int rowCount, const float *data);
+
+    /**
+     * @brief 设置热力图覆盖的矩形区域（OpenGL 坐标）
+     */
+    void setRect(const QVector2D &min, const QVector2D &max) {
+      m_rectMin = min;
+      m_rectMax = max;
+    }
+
+    /**
+     * @brief 绘制热力图，返回前恢复深度测试与混合状态
+     * @param projection 投影矩阵
+     * @param view 视图矩阵
+     * @param maxValue 颜色归一化使用的最大值
+     * @param minValue 小于等于该值的格子不绘制
+     */
+    void draw(const QMatrix4x4 &projection, const QMatrix4x4 &view, float maxValue, float minValue = 0.0f);
+
+    /**
+     * @brief 销毁 GPU 资源
+     */
+    void destroy();
+
+    int rows() const { return m_rows; }
+    int cols() const { return m_cols; }
+
+  private:
+    void initializeShader();
+
+    // 链接后解析一次的 uniform 位置，投影与视图矩阵走 CameraBlock
+    struct UniformLocations {
+      int rectMin = -1;
+      int rectMax = -1;
+      int gridSize = -1;
+      int maxValue = -1;
+      int minValue = -1;
+    };
+
+    std::unique_ptr<QOpenGLShaderProgram> m_program;
+    UniformLocations m_uniforms;
+    QOpenGLVertexArrayObject m_vao;
+    QOpenGLBuffer m_vbo{QOpenGLBuffer::VertexBuffer};
+    GLuint m_texture = 0;
+    int m_rows = 0;
+    int m_cols = 0;
+    bool m_textureDirty = true;
+    QVector2D m_rectMin{0.0f, 0.0f};
+    QVector2D m_rectMax{1.0f, 1.0f};
+  };
+} // namespace ProGraphics
@@ -4,57 +4,13 @@
 #include <QOpenGLExtraFunctions>
 #include <QOpenGLShaderProgram>
 #include <QOpenGLVertexArrayObject>
-#include <queue>
+#include "prographics/core/graphics/camera_uniform_buffer.h"
+#include "prographics/core/graphics/gpu_buffer_allocator.h"
+#include "prographics/core/graphics/streaming_buffer.h"
+#include <algorithm>
+#include <cstdint>
 
 namespace ProGraphics {
-  /**
- * @brief OpenGL顶点缓冲区池
- *
- * 管理和复用OpenGL顶点缓冲区对象(VBO)，避免频繁创建和销毁
- */
-  class VertexBufferPool {
-  public:
-    /**
-    * @brief 获取单例实例
-    */
-    static VertexBufferPool &getInstance() {
-      static VertexBufferPool instance;
-      return instance;
-    }
-
-    /**
-   * @brief 获取一个可用的缓冲区
-   * @return 可用的OpenGL缓冲区指针
-   */
-    QOpenGLBuffer *acquire();
-
-    /**
-  * @brief 释放一个缓冲区回池中
-  * @param buffer 要释放的缓冲区指针
-  */
-    void release(QOpenGLBuffer *buffer);
-
-    /**
-   * @brief 清理所有缓冲区
-   */
-    void cleanup(); // 清理所有缓冲区
-
-  private:
-    VertexBufferPool() = default;
-
-    ~VertexBufferPool();
-
-    // 禁用拷贝
-    VertexBufferPool(const VertexBufferPool &) = delete;
-
-    VertexBufferPool &operator=(const VertexBufferPool &) = delete;
-
-    std::vector<QOpenGLBuffer> m_buffers;
-    std::queue<size_t> m_availableBuffers;
-    static constexpr size_t INITIAL_POOL_SIZE = 32;
-    static constexpr size_t GROWTH_FACTOR = 16;
-  }; // namespace class VertexBufferPool
-
   /**
  * @brief 2D图元的顶点属性结构
  */
@@ -79,10 +35,18 @@ namespace ProGraphics {
   /**
  * @brief 2D图元批量渲染管理器
  *
- * 通过批处理技术优化渲染性能
+ * 保留式批处理：
+ * - 顶点直接追加到持久暂存区，begin() 只清空不释放，GPU 缓冲容量足够时原地覆盖
+ * - update() 改写单个图元的顶点，只上传被修改的区间
+ * - 同一图元类型的所有图元合并提交：GL_LINES/GL_POINTS/GL_TRIANGLES 相邻区间合并为一段，
+ *   其余区间（以及条带、扇形）用一次 glMultiDrawArrays 提交
+ *
+ * 不同图元类型按首次出现的顺序绘制。
  */
   class Primitive2DBatch {
   public:
+    static constexpr int FLOATS_PER_VERTEX = 7; ///< 位置(3) + 颜色(4)
+
     Primitive2DBatch() = default;
 
     ~Primitive2DBatch() {
@@ -95,21 +59,47 @@ namespace ProGraphics {
     }
 
     /**
-     * @brief 开始批处理
+     * @brief 开始批处理，清空已有图元（保留暂存区与 GPU 缓冲的容量）
      */
     void begin();
 
     /**
      * @brief 添加图元到批处理
-     * @param vertices 顶点数据
+     * @param vertices 顶点数据，每个顶点 FLOATS_PER_VERTEX 个浮点数
      * @param vertexCount 顶点数量
      * @param primitiveType 图元类型
+     * @return 图元在批处理中的序号，供 update() 使用
+     */
+    size_t add(const float *vertices, int vertexCount, GLenum primitiveType);
+
+    size_t add(const std::vector<float> &vertices, int vertexCount,
+               GLenum primitiveType);
+
+    /**
+     * @brief 在暂存区末尾追加 vertexCount 个顶点的空间，由调用方直接写入
+     * @return 可写的顶点数据，在下一次 begin()/add()/append() 之前有效；图元序号为 itemCount() - 1
      */
-    void add(const std::vector<float> &vertices, int vertexCount,
-             GLenum primitiveType);
+    float *append(int vertexCount, GLenum primitiveType);
+
+    /**
+     * @brief 改写已添加图元的顶点（顶点数不变），下次 end() 或 draw() 时只上传改写的区间
+     * @param item add() 返回的序号
+     * @param vertices 顶点数据，超出原顶点数的部分被忽略
+     */
+    void update(size_t item, const std::vector<float> &vertices);
+
+    /**
+     * @brief 取得已添加图元在暂存区中的顶点以便原地改写，并将其标记为待上传
+     * @return 可写的顶点数据（vertexCount(item) 个顶点），序号无效时返回 nullptr
+     */
+    float *update(size_t item);
+
+    int vertexCount(size_t item) const {
+      return item < m_items.size() ? m_items[item].vertexCount : 0;
+    }
 
     /**
-     * @brief 结束批处理
+     * @brief 结束批处理，上传待更新的顶点
      */
     void end();
 
@@ -123,14 +113,39 @@ namespace ProGraphics {
     void setStyle(const Primitive2DStyle &style) { m_style = style; }
     const Primitive2DStyle &style() const { return m_style; }
 
+    size_t itemCount() const { return m_items.size(); }
+
   private:
     struct BatchItem {
-      std::vector<float> vertices;
-      int vertexCount;
+      GLint first; ///< 在暂存区中的起始顶点
+      GLsizei vertexCount;
       GLenum primitiveType;
     };
 
+    // 同一图元类型的一次提交
+    struct DrawGroup {
+      GLenum primitiveType;
+      std::vector<GLint> firsts;
+      std::vector<GLsizei> counts;
+    };
+
+    using MultiDrawArraysProc = void (QOPENGLF_APIENTRYP)(GLenum, const GLint *, const GLsizei *, GLsizei);
+
+    void markDirty(size_t firstVertex, size_t vertexCount);
+
+    void uploadPending();
+
+    void rebuildDrawGroups();
+
     std::vector<BatchItem> m_items;
+    std::vector<float> m_staging; ///< 持久暂存区
+    std::vector<DrawGroup> m_drawGroups;
+    size_t m_dirtyBegin = 0; ///< 待上传的顶点区间 [m_dirtyBegin, m_dirtyEnd)
+    size_t m_dirtyEnd = 0;
+    size_t m_gpuVertexCapacity = 0;
+    bool m_groupsDirty = true;
+    MultiDrawArraysProc m_multiDrawArrays = nullptr;
+    bool m_multiDrawResolved = false;
     QOpenGLBuffer m_batchVBO;
     QOpenGLVertexArrayObject m_batchVAO;
     Primitive2DStyle m_style;
@@ -155,6 +170,39 @@ namespace ProGraphics {
     }
   };
 
+  /**
+ * @brief 实例化绘制的紧凑实例数据（24 字节）
+ *
+ * 只保存位置、缩放、旋转和 RGBA8 颜色，模型矩阵在顶点着色器中组合，
+ * 上传量约为完整矩阵加颜色（80 字节）的 1/3，且 CPU 端不再逐实例计算矩阵。
+ */
+  struct Primitive2DInstance {
+    float position[2] = {0.0f, 0.0f}; ///< 位置
+    float scale[2] = {1.0f, 1.0f}; ///< 缩放
+    float rotation = 0.0f; ///< 旋转角度(弧度)
+    uint8_t color[4] = {255, 255, 255, 255}; ///< 归一化 RGBA8 颜色
+
+    void setColor(const QVector4D &rgba) {
+      for (int i = 0; i < 4; ++i) {
+        const float c = std::clamp(rgba[i], 0.0f, 1.0f);
+        color[i] = static_cast<uint8_t>(c * 255.0f + 0.5f);
+      }
+    }
+
+    static Primitive2DInstance fromTransform(const Transform2D &transform) {
+      Primitive2DInstance instance;
+      instance.position[0] = transform.position.x();
+      instance.position[1] = transform.position.y();
+      instance.scale[0] = transform.scale.x();
+      instance.scale[1] = transform.scale.y();
+      instance.rotation = transform.rotation;
+      instance.setColor(transform.color);
+      return instance;
+    }
+  };
+
+  static_assert(sizeof(Primitive2DInstance) == 24, "Primitive2DInstance must stay tightly packed");
+
   /**
  * @brief 2D图元基类
  *
@@ -196,6 +244,16 @@ namespace ProGraphics {
                        float alphaReplace = -1.0f,
                        bool uploadInstanceData = true);
 
+    /**
+     * @brief 使用紧凑实例数据绘制多个实例，参数含义同上
+     *
+     * 实例数据直接上传，不做任何转换；适合由调用方缓存实例数组的场景。
+     */
+    void drawInstanced(const QMatrix4x4 &projection, const QMatrix4x4 &view,
+                       const std::vector<Primitive2DInstance> &instances,
+                       float alphaReplace = -1.0f,
+                       bool uploadInstanceData = true);
+
     /**
      * @brief 销毁图元
      */
@@ -259,6 +317,9 @@ namespace ProGraphics {
     // 设置顶点缓冲
     void setupBuffer(const std::vector<float> &vertices, int stride);
 
+    // 按分配器当前的缓冲区与偏移设置顶点属性（分配器整理后需重新调用）
+    void bindVertexAttributes();
+
     void setupIndexBuffer(const std::vector<GLuint> &indices);
 
     void markDirty() { m_isDirty = true; }
@@ -276,10 +337,12 @@ namespace ProGraphics {
 
     void initializeInstanceBuffer();
 
-    void updateInstanceData(const std::vector<Transform2D> &transforms);
+    void updateInstanceData(const Primitive2DInstance *instances, size_t count);
 
     QOpenGLVertexArrayObject m_vao;
-    QOpenGLBuffer *m_managedVBO = nullptr;
+    GpuBufferHandle m_vertexAllocation; ///< 顶点数据在共享缓冲区中的块
+    uint64_t m_vertexEpoch = 0; ///< 设置顶点属性时分配器的整理代数
+    int m_vertexStride = 0;
     QOpenGLBuffer m_ibo{QOpenGLBuffer::IndexBuffer};
     int m_indexCount = 0;
     bool m_useIndices = false;
@@ -295,7 +358,16 @@ namespace ProGraphics {
     static std::unique_ptr<QOpenGLShaderProgram> s_shaderProgram;
     static int s_shaderUsers; // 引用计数
 
-    QOpenGLBuffer m_instanceVBO; // 实例化缓冲
+    // 链接后解析一次的 uniform 位置，投影与视图矩阵走 CameraBlock
+    struct UniformLocations {
+      int pointSize = -1;
+      int useInstancing = -1;
+      int alphaReplace = -1;
+    };
+    static UniformLocations s_uniforms;
+
+    StreamingBuffer m_instanceBuffer; // 实例化缓冲（按容量增长，上传时孤立旧存储）
+    std::vector<Primitive2DInstance> m_instanceStaging; // Transform2D 转换暂存区
     bool m_instancedMode = false; // 是否启用实例化模式
 
     friend class Primitive2DBatch;
@@ -376,6 +448,16 @@ namespace ProGraphics {
     const QVector3D &start() const { return m_start; }
     const QVector3D &end() const { return m_end; }
 
+    /**
+     * @brief 批处理中占用的顶点数
+     */
+    int batchVertexCount() const { return m_points.empty() ? 2 : static_cast<int>(m_points.size()); }
+
+    /**
+     * @brief 直接写出 batchVertexCount() 个批处理顶点，不经过临时数组
+     */
+    void writeBatchVertices(float *out) const;
+
     void addToRenderBatch(Primitive2DBatch &batch) override;
 
   protected:
@@ -0,0 +1,20 @@
+﻿#pragma once
+
+namespace ProGraphics {
+  /**
+   * @brief 着色器共用的强度颜色映射，与 CPU 端的 calculateColor（utils.h）一致：蓝(240°) -> 红(0°)
+   *
+   * 定义 hsv2rgb(vec3 hsv) 与 intensityColor(float intensity, float value)，
+   * 拼接在着色器的 #version 与声明之后、main 之前。
+   */
+  inline constexpr const char *INTENSITY_COLORMAP_GLSL = R"(
+            vec3 hsv2rgb(vec3 c) {
+                vec3 p = abs(fract(c.xxx + vec3(1.0, 2.0 / 3.0, 1.0 / 3.0)) * 6.0 - 3.0);
+                return c.z * mix(vec3(1.0), clamp(p - 1.0, 0.0, 1.0), c.y);
+            }
+
+            vec3 intensityColor(float intensity, float value) {
+                return hsv2rgb(vec3((240.0 - intensity * 240.0) / 360.0, 1.0, value));
+            }
+)";
+} // namespace ProGraphics
@@ -1,4 +1,4 @@
-#pragma once
+﻿#pragma once
 #include <QMatrix4x4>
 #include <QOpenGLBuffer>
 #include <QOpenGLFunctions>
@@ -7,6 +7,8 @@
 #include <QOpenGLTexture>
 #include <QQuaternion>
 #include <QOpenGLVertexArrayObject>
+#include "prographics/core/graphics/camera_uniform_buffer.h"
+#include "prographics/core/graphics/streaming_buffer.h"
 
 namespace ProGraphics {
     /**
@@ -163,11 +165,34 @@ namespace ProGraphics {
         static std::unique_ptr<QOpenGLShaderProgram> s_shaderProgram; ///< 共享着色器程序
         static int s_shaderUsers; ///< 着色器程序使用计数
 
+        /**
+         * @brief 链接后解析一次的 uniform 位置，投影与视图矩阵走 CameraBlock
+         */
+        struct UniformLocations {
+            int model = -1;
+            int useInstancing = -1;
+            int ambient = -1;
+            int diffuse = -1;
+            int specular = -1;
+            int shininess = -1;
+            int opacity = -1;
+            int wireframe = -1;
+            int wireframeColor = -1;
+            int useTexture = -1;
+            int lightPos = -1;
+            int viewPos = -1;
+        };
+
+        static UniformLocations s_uniforms; ///< 共享着色器程序的 uniform 位置
+
         // 着色器相关方法
         void initializeShader();
 
         void releaseShader();
 
+        // 设置相机块与模型、材质、光照 uniform，调用前需绑定着色器程序
+        void applyUniforms(const QMatrix4x4 &projection, const QMatrix4x4 &view, bool instancing);
+
         void setupBuffer(const std::vector<float> &vertices, int stride);
 
         // LOD 相关
@@ -176,7 +201,7 @@ namespace ProGraphics {
         float m_lodThreshold = 10.0f; ///< LOD切换阈值
 
         // 实例化渲染缓冲
-        QOpenGLBuffer m_instanceVBO;
+        StreamingBuffer m_instanceBuffer; ///< 按容量增长，上传时孤立旧存储
         bool m_instancedMode = false;
 
         virtual void initializeInstanceBuffer();
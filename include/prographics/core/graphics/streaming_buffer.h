@@ -0,0 +1,117 @@
+﻿#pragma once
+#include "prographics/prographics_export.h"
+#include <QOpenGLExtraFunctions>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+namespace ProGraphics {
+  /**
+   * @brief 按容量管理的流式 GPU 缓冲（用于每帧或频繁更新的实例数据）
+   *
+   * - 容量不足时按 2 倍几何增长，容量足够时不重新分配
+   * - 每次上传先以 glBufferData(nullptr) 孤立旧存储，再用 glBufferSubData 写入，
+   *   驱动可为仍在使用的旧内容另行分配，上传不会等待 GPU
+   * - 自带一个复用的 CPU 暂存区，调用方可直接在其中组装数据
+   *
+   * 上传字节数与重新分配次数计入当前激活的 FrameStats（见 FrameStatsScope）。
+   * BaseGLWidget::paintGL 在绘制期间激活该控件自己的统计，多个控件互不干扰；
+   * 不在任何作用域内的上传不计入统计。
+   */
+  class PROGRAPHICS_EXPORT StreamingBuffer : protected QOpenGLExtraFunctions {
+  public:
+    /**
+     * @brief 每帧上传统计
+     */
+    struct FrameStats {
+      size_t bytesUploaded = 0; ///< 上传字节数
+      size_t uploads = 0; ///< 上传次数
+      size_t reallocations = 0; ///< 重新分配 GPU 存储的次数
+    };
+
+    /**
+     * @brief 在作用域内将上传统计计入 stats，析构时恢复之前激活的统计
+     *
+     * 只在 GUI 线程（持有 GL 上下文的线程）使用，可以嵌套。
+     */
+    class PROGRAPHICS_EXPORT FrameStatsScope {
+    public:
+      explicit FrameStatsScope(FrameStats *stats);
+
+      ~FrameStatsScope();
+
+      FrameStatsScope(const FrameStatsScope &) = delete;
+
+      FrameStatsScope &operator=(const FrameStatsScope &) = delete;
+
+    private:
+      FrameStats *m_previous;
+    };
+
+    explicit StreamingBuffer(GLenum target = GL_ARRAY_BUFFER, GLenum usage = GL_STREAM_DRAW);
+
+    ~StreamingBuffer();
+
+    StreamingBuffer(const StreamingBuffer &) = delete;
+
+    StreamingBuffer &operator=(const StreamingBuffer &) = delete;
+
+    /**
+     * @brief 创建缓冲对象（不分配存储）
+     * 必须在OpenGL上下文中调用
+     */
+    void create();
+
+    bool isCreated() const { return m_buffer != 0; }
+
+    GLuint bufferId() const { return m_buffer; }
+
+    void bind();
+
+    void release();
+
+    /**
+     * @brief 当前 GPU 存储容量（字节）
+     */
+    size_t capacity() const { return m_capacity; }
+
+    /**
+     * @brief 预留至少 bytes 字节的 GPU 存储，内容不保留
+     */
+    void reserve(size_t bytes);
+
+    /**
+     * @brief 上传 bytes 字节到缓冲起始处，必要时扩容
+     */
+    void upload(const void *data, size_t bytes);
+
+    /**
+     * @brief 取得可容纳 count 个 T 的暂存区，内容未定义；随后以 uploadStaged 上传
+     */
+    template<typename T>
+    T *stage(size_t count) {
+      static_assert(std::is_trivially_copyable_v<T>, "staging only supports trivially copyable types");
+      m_staging.resize(count * sizeof(T));
+      return reinterpret_cast<T *>(m_staging.data());
+    }
+
+    /**
+     * @brief 上传暂存区的前 bytes 字节
+     */
+    void uploadStaged(size_t bytes);
+
+    /**
+     * @brief 销毁缓冲对象
+     */
+    void destroy();
+
+  private:
+    static constexpr size_t MIN_CAPACITY = 4096;
+
+    GLenum m_target;
+    GLenum m_usage;
+    GLuint m_buffer = 0;
+    size_t m_capacity = 0;
+    std::vector<std::byte> m_staging;
+  };
+} // namespace ProGraphics
@@ -0,0 +1,82 @@
+﻿#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+namespace ProGraphics {
+    /**
+     * @brief 按缓存行对齐的定长连续缓冲区
+     *
+     * 一次分配、连续存放，首地址按 Alignment 对齐（默认 64 字节缓存行），
+     * 适合作为行优先二维网格的底层存储。
+     * - resize() 会重新分配并清零，不保留旧内容
+     * - 只支持移动，不支持拷贝
+     *
+     * @tparam T 元素类型（需为平凡类型）
+     * @tparam Alignment 对齐字节数
+     */
+    template<typename T, std::size_t Alignment = 64>
+    class AlignedBuffer {
+        static_assert(std::is_trivially_copyable_v<T>, "AlignedBuffer 只支持平凡类型");
+        static_assert((Alignment & (Alignment - 1)) == 0, "Alignment 必须是 2 的幂");
+
+    public:
+        AlignedBuffer() = default;
+
+        explicit AlignedBuffer(std::size_t size) { resize(size); }
+
+        AlignedBuffer(AlignedBuffer &&) noexcept = default;
+
+        AlignedBuffer &operator=(AlignedBuffer &&) noexcept = default;
+
+        AlignedBuffer(const AlignedBuffer &) = delete;
+
+        AlignedBuffer &operator=(const AlignedBuffer &) = delete;
+
+        /**
+         * @brief 重新分配为 size 个元素并清零
+         */
+        void resize(std::size_t size) {
+            if (size != m_size) {
+                m_data.reset(size > 0 ? allocate(size) : nullptr);
+                m_size = size;
+            }
+            fill(T{});
+        }
+
+        /**
+         * @brief 用指定值填充全部元素
+         */
+        void fill(const T &value) { std::fill(begin(), end(), value); }
+
+        T *data() { return m_data.get(); }
+        const T *data() const { return m_data.get(); }
+
+        std::size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+
+        T &operator[](std::size_t index) { return m_data[index]; }
+        const T &operator[](std::size_t index) const { return m_data[index]; }
+
+        T *begin() { return data(); }
+        T *end() { return data() + m_size; }
+        const T *begin() const { return data(); }
+        const T *end() const { return data() + m_size; }
+
+    private:
+        struct Deleter {
+            void operator()(T *ptr) const { ::operator delete[](ptr, std::align_val_t{Alignment}); }
+        };
+
+        static T *allocate(std::size_t size) {
+            // 按对齐粒度向上取整，使最后一行之后不会与其他数据共享缓存行
+            const std::size_t bytes = (size * sizeof(T) + Alignment - 1) / Alignment * Alignment;
+            return static_cast<T *>(::operator new[](bytes, std::align_val_t{Alignment}));
+        }
+
+        std::unique_ptr<T[], Deleter> m_data;
+        std::size_t m_size = 0;
+    };
+} // namespace ProGraphics
@@ -0,0 +1,35 @@
+﻿#pragma once
+#include "prographics/prographics_export.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace ProGraphics {
+    /**
+     * @brief 压缩周期的解码参数
+     */
+    struct CycleCodecParams {
+        float offset = 0.0f;
+        float scale = 0.0f;
+    };
+
+    /**
+     * @brief 16 位定点编码，每周期独立的最小值与步长
+     *
+     * 范围只由有限值确定；+inf 编码为周期最大值，-inf 与 NaN 编码为周期最小值。
+     * 有限值的解码误差不超过 (周期最大值 - 最小值) / 131070。
+     */
+    PROGRAPHICS_EXPORT CycleCodecParams encodeCycleInt16(const float *in, size_t count, uint16_t *out);
+
+    PROGRAPHICS_EXPORT void decodeCycleInt16(const uint16_t *in, size_t count, CycleCodecParams params, float *out);
+
+    /**
+     * @brief 8 位 μ-law 对数编码（μ = 255），作用于到周期峰值的距离
+     *
+     * 范围只由有限值确定；+inf 编码为周期最大值，-inf 与 NaN 编码为周期最小值。
+     * 设 u = (周期最大值 - x) / 范围，有限值的解码误差不超过
+     * 范围 × (1 + 255u) / 255 × (256^(1/510) - 1)，越接近峰值精度越高。
+     */
+    PROGRAPHICS_EXPORT CycleCodecParams encodeCycleLogUInt8(const float *in, size_t count, uint8_t *out);
+
+    PROGRAPHICS_EXPORT void decodeCycleLogUInt8(const uint8_t *in, size_t count, CycleCodecParams params, float *out);
+} // namespace ProGraphics
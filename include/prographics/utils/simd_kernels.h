@@ -0,0 +1,96 @@
+﻿#pragma once
+#include "prographics/prographics_export.h"
+#include <cstddef>
+#include <cstdint>
+
+namespace ProGraphics {
+    /**
+     * @brief 单个幅值的分格计算（标量参考实现，与向量化内核结果一致）
+     *
+     * bin = floor(clamp((x - min) * invRange, 0, 0.9999) * bins)
+     * - x <= min 落入第 0 格，x >= max 落入最后一格
+     * - NaN 落入第 0 格
+     */
+    inline uint16_t binAmplitude(float x, float min, float invRange, int bins) {
+        float t = (x - min) * invRange;
+        t = t > 0.0f ? t : 0.0f; // NaN 比较为 false，归零
+        t = t < 0.9999f ? t : 0.9999f;
+        return static_cast<uint16_t>(static_cast<int>(t * static_cast<float>(bins)));
+    }
+
+    /**
+     * @brief 批量幅值分格
+     *
+     * 量程在调用前折算为 min / invRange，循环内无分支。
+     * x86 平台运行时选择 AVX2 或 SSE2 实现，其他平台使用标量实现。
+     * 量程宽度小于 1e-6 时退化为：<=min 为 0，>=max 为最后一格，其余为中间格。
+     *
+     * @param in 输入幅值
+     * @param out 输出格子索引
+     * @param count 元素个数
+     * @param min 量程下限
+     * @param max 量程上限
+     * @param bins 格子数（不超过 32767）
+     */
+    PROGRAPHICS_EXPORT void binAmplitudes(const float *in, uint16_t *out, size_t count,
+                                          float min, float max, int bins);
+
+    /**
+     * @brief 分桶最小/最大值包络抽取（单次遍历）
+     *
+     * 将 [0, count) 按 [b * count / buckets, (b + 1) * count / buckets) 切分为 buckets 个桶，
+     * 输出每个桶的最小值、最大值以及最大值首次出现的位置。
+     * NaN 不参与比较；空桶或全为 NaN 的桶输出 min = +inf、max = -inf、argMax = 桶起点。
+     *
+     * @param in 输入序列
+     * @param count 元素个数
+     * @param buckets 桶数
+     * @param outMin 每桶最小值，可为 nullptr
+     * @param outMax 每桶最大值
+     * @param outArgMax 每桶最大值所在下标（相对 in），可为 nullptr
+     */
+    PROGRAPHICS_EXPORT void decimateMinMax(const float *in, size_t count, size_t buckets,
+                                           float *outMin, float *outMax, uint32_t *outArgMax);
+
+    /**
+     * @brief decimateMinMax 的标量参考实现，输出与向量化内核逐位一致（供测试与基准对照）
+     */
+    PROGRAPHICS_EXPORT void decimateMinMaxScalar(const float *in, size_t count, size_t buckets,
+                                                 float *outMin, float *outMax, uint32_t *outArgMax);
+
+    /**
+     * @brief 逐元素峰值保持：acc[i] = max(acc[i], in[i])，in[i] 为 NaN 时保持 acc[i]
+     */
+    PROGRAPHICS_EXPORT void accumulateMax(float *acc, const float *in, size_t count);
+
+    /**
+     * @brief 逐元素累加：acc[i] += in[i]
+     */
+    PROGRAPHICS_EXPORT void accumulateSum(float *acc, const float *in, size_t count);
+
+    /**
+     * @brief 逐元素计数：in[i] > threshold 时 acc[i] += 1（NaN 不计数）
+     */
+    PROGRAPHICS_EXPORT void accumulateCount(float *acc, const float *in, size_t count, float threshold);
+
+    /**
+     * @brief 幅值门限：in[i] >= threshold 且 in[i] > floor[i] + margin 时 out[i] = in[i]，否则为 -inf
+     *
+     * floor 为 nullptr 时只比较 threshold；NaN 一律被门限滤除。in 与 out 可以相同。
+     */
+    PROGRAPHICS_EXPORT void gateSamples(const float *in, const float *floor, float margin, float threshold,
+                                        float *out, size_t count);
+
+    /**
+     * @brief 逐元素分位数流式估计（Frugal 算法）
+     *
+     * in[i] > estimate[i] 时 estimate[i] += step * quantile，
+     * in[i] < estimate[i] 时 estimate[i] -= step * (1 - quantile)，NaN 不更新。
+     */
+    PROGRAPHICS_EXPORT void trackQuantile(float *estimate, const float *in, size_t count, float quantile, float step);
+
+    /**
+     * @brief 当前向量化内核使用的指令集名称（"avx2" / "sse2" / "scalar"）
+     */
+    PROGRAPHICS_EXPORT const char *simdKernelIsa();
+} // namespace ProGraphics
@@ -0,0 +1,210 @@
+﻿#pragma once
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+namespace ProGraphics {
+    /**
+     * @brief 队列满时的处理策略
+     */
+    enum class OverflowPolicy {
+        DropOldest, ///< 丢弃最老的周期，保证最新数据进入队列
+        DropNewest, ///< 丢弃正在写入的新周期
+        Block ///< 等待消费者腾出空间，超过 blockTimeout() 仍然满时丢弃正在写入的新周期
+    };
+
+    /**
+     * @brief 单生产者/单消费者无锁周期队列
+     *
+     * 每个槽位存放一个定长周期（cycleSize 个 float），所有槽位在一次分配中连续存放。
+     * - 生产者线程调用 push()，不加锁、不分配内存
+     * - 消费者线程（GUI 线程）调用 popAll() 一次性取出全部待处理周期
+     * - DropOldest 策略下生产者与消费者通过 CAS 竞争推进读指针，
+     *   消费者先拷贝再提交，提交失败说明该周期已被丢弃，拷贝结果作废
+     *
+     * reset() 在消费者线程调用，可与 push() 并发：重新分配前等待正在进行的 push() 结束，
+     * 重新分配期间到达的 push() 直接返回 false，不会写入已释放的存储。
+     * reset() 不得与 popAll() 并发。
+     *
+     * Block 策略的等待有上限：消费者停止取数据（例如控件被隐藏、GUI 线程卡住）时，
+     * 生产者最多等待 blockTimeout()，之后按 DropNewest 处理并计入 droppedCount()。
+     */
+    class SpscCycleQueue {
+    public:
+        SpscCycleQueue() = default;
+
+        SpscCycleQueue(size_t capacity, size_t cycleSize) { reset(capacity, cycleSize); }
+
+        SpscCycleQueue(const SpscCycleQueue &) = delete;
+
+        SpscCycleQueue &operator=(const SpscCycleQueue &) = delete;
+
+        /**
+         * @brief 重新分配队列并清空内容（仅消费者线程调用）
+         * @param capacity 最多缓存的周期数
+         * @param cycleSize 每个周期的元素个数
+         */
+        void reset(size_t capacity, size_t cycleSize) {
+            // 与 push() 中的 m_writing/m_resizing 构成 Dekker 式握手，两侧都用 seq_cst
+            m_resizing.store(true, std::memory_order_seq_cst);
+            while (m_writing.load(std::memory_order_seq_cst)) {
+                std::this_thread::yield();
+            }
+
+            m_capacity = std::max<size_t>(capacity, 1);
+            // 多留一个槽位，DropOldest 时生产者写入的槽位永远不会是消费者正在读取的槽位
+            m_slotCount = m_capacity + 1;
+            m_cycleSize = cycleSize;
+            m_storage.assign(m_slotCount * m_cycleSize, 0.0f);
+            m_head.store(0, std::memory_order_relaxed);
+            m_tail.store(0, std::memory_order_relaxed);
+            m_dropped.store(0, std::memory_order_relaxed);
+
+            m_resizing.store(false, std::memory_order_seq_cst);
+        }
+
+        /**
+         * @brief 设置溢出策略（可在任意线程调用）
+         */
+        void setOverflowPolicy(OverflowPolicy policy) { m_policy.store(policy, std::memory_order_relaxed); }
+
+        OverflowPolicy overflowPolicy() const { return m_policy.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief 设置 Block 策略下单次 push() 的最长等待时间（可在任意线程调用）
+         */
+        void setBlockTimeout(std::chrono::microseconds timeout) {
+            m_blockTimeout.store(std::max<int64_t>(timeout.count(), 0), std::memory_order_relaxed);
+        }
+
+        std::chrono::microseconds blockTimeout() const {
+            return std::chrono::microseconds(m_blockTimeout.load(std::memory_order_relaxed));
+        }
+
+        size_t capacity() const { return m_capacity; }
+
+        size_t cycleSize() const { return m_cycleSize; }
+
+        /**
+         * @brief 当前待处理的周期数（近似值）
+         */
+        size_t size() const {
+            const uint64_t head = m_head.load(std::memory_order_acquire);
+            const uint64_t tail = m_tail.load(std::memory_order_acquire);
+            return static_cast<size_t>(head - tail);
+        }
+
+        /**
+         * @brief 累计被丢弃的周期数
+         */
+        uint64_t droppedCount() const { return m_dropped.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief 写入一个周期（仅生产者线程调用）
+         * @param data 周期数据
+         * @param count 元素个数，必须等于 cycleSize()
+         * @return 是否写入成功（长度不符、队列正在重新分配、DropNewest 策略下队列已满
+         *         或 Block 策略等待超时时返回 false）
+         */
+        bool push(const float *data, size_t count) {
+            m_writing.store(true, std::memory_order_seq_cst);
+            const bool written = !m_resizing.load(std::memory_order_seq_cst) && pushLocked(data, count);
+            m_writing.store(false, std::memory_order_release);
+            return written;
+        }
+
+        /**
+         * @brief 取出全部待处理周期并追加到 out 末尾（仅消费者线程调用）
+         * @return 取出的周期数
+         */
+        size_t popAll(std::vector<float> &out) {
+            size_t popped = 0;
+            uint64_t tail = m_tail.load(std::memory_order_acquire);
+            while (true) {
+                const uint64_t head = m_head.load(std::memory_order_acquire);
+                if (tail == head) {
+                    break;
+                }
+
+                const size_t offset = out.size();
+                const float *src = slot(tail);
+                out.insert(out.end(), src, src + m_cycleSize);
+
+                // 提交失败：生产者已丢弃该周期，撤销拷贝并从新的 tail 继续
+                if (!m_tail.compare_exchange_strong(tail, tail + 1, std::memory_order_acq_rel)) {
+                    out.resize(offset);
+                    continue;
+                }
+                ++tail;
+                ++popped;
+            }
+            return popped;
+        }
+
+    private:
+        // 调用方已确认当前没有重新分配
+        bool pushLocked(const float *data, size_t count) {
+            if (count != m_cycleSize || m_storage.empty()) {
+                return false;
+            }
+
+            const uint64_t head = m_head.load(std::memory_order_relaxed);
+            uint64_t tail = m_tail.load(std::memory_order_acquire);
+            std::chrono::steady_clock::time_point deadline{};
+            bool waiting = false;
+            while (head - tail >= m_capacity) {
+                switch (m_policy.load(std::memory_order_relaxed)) {
+                    case OverflowPolicy::DropNewest:
+                        m_dropped.fetch_add(1, std::memory_order_relaxed);
+                        return false;
+                    case OverflowPolicy::DropOldest:
+                        // 失败说明消费者刚取走一个周期，tail 已被更新，重新判断即可
+                        if (m_tail.compare_exchange_weak(tail, tail + 1, std::memory_order_acq_rel)) {
+                            m_dropped.fetch_add(1, std::memory_order_relaxed);
+                            ++tail;
+                        }
+                        break;
+                    case OverflowPolicy::Block:
+                        // 消费者要重新分配时不再等待，否则 reset() 会一直等这次 push 结束
+                        if (m_resizing.load(std::memory_order_seq_cst)) {
+                            return false;
+                        }
+                        // 只在队列满时读时钟，未满的 push() 不承担计时开销
+                        if (!waiting) {
+                            deadline = std::chrono::steady_clock::now() + blockTimeout();
+                            waiting = true;
+                        } else if (std::chrono::steady_clock::now() >= deadline) {
+                            m_dropped.fetch_add(1, std::memory_order_relaxed);
+                            return false;
+                        }
+                        std::this_thread::yield();
+                        tail = m_tail.load(std::memory_order_acquire);
+                        break;
+                }
+            }
+
+            std::copy(data, data + count, slot(head));
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        float *slot(uint64_t index) { return m_storage.data() + (index % m_slotCount) * m_cycleSize; }
+
+        std::vector<float> m_storage;
+        size_t m_capacity = 0;
+        size_t m_slotCount = 0;
+        size_t m_cycleSize = 0;
+        std::atomic<OverflowPolicy> m_policy{OverflowPolicy::DropOldest};
+        std::atomic<uint64_t> m_dropped{0};
+        std::atomic<int64_t> m_blockTimeout{100000}; ///< Block 策略的等待上限（微秒）
+        std::atomic<bool> m_writing{false}; ///< 生产者正在 push()
+        std::atomic<bool> m_resizing{false}; ///< 消费者正在 reset()
+
+        alignas(64) std::atomic<uint64_t> m_head{0}; ///< 生产者写入位置
+        alignas(64) std::atomic<uint64_t> m_tail{0}; ///< 消费者读取位置
+    };
+} // namespace ProGraphics
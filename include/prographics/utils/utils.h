@@ -79,6 +79,20 @@ namespace ProGraphics {
         return hsvToRgb(hue, saturation, value, alpha);
     }
 
+    // 统计一块按行存放的数据（rows 行，每行取前 cols 个，行间距 stride 个元素）的最小/最大值
+    inline std::pair<float, float> blockMinMax(const float *data, size_t rows, size_t cols, size_t stride) {
+        float minValue = data[0];
+        float maxValue = data[0];
+        for (size_t r = 0; r < rows; ++r) {
+            const float *row = data + r * stride;
+            for (size_t c = 0; c < cols; ++c) {
+                minValue = std::min(minValue, row[c]);
+                maxValue = std::max(maxValue, row[c]);
+            }
+        }
+        return {minValue, maxValue};
+    }
+
     // 优化的刻度计算函数
     inline float calculateNiceTickStep(float range, int targetTicks = 6) {
         if (range <= 0 || targetTicks <= 1) {
@@ -287,13 +301,20 @@ namespace ProGraphics {
 
         // 更新范围，返回是否需要重建绘图数据
         bool updateRange(const std::vector<float> &newData) {
-            if (newData.empty())
+            return updateRange(newData.data(), newData.size());
+        }
+
+        // 对一段连续数据更新范围（如一整块周期数据），返回是否需要重建绘图数据
+        bool updateRange(const float *data, size_t count) {
+            if (data == nullptr || count == 0)
                 return false;
 
-            auto [minIt, maxIt] = std::minmax_element(newData.begin(), newData.end());
-            float dataMin = *minIt;
-            float dataMax = *maxIt;
+            auto [minIt, maxIt] = std::minmax_element(data, data + count);
+            return updateRangeFromBounds(*minIt, *maxIt);
+        }
 
+        // 使用已统计好的数据最小/最大值更新范围，返回是否需要重建绘图数据
+        bool updateRangeFromBounds(float dataMin, float dataMax) {
             float oldMin = m_currentMin;
             float oldMax = m_currentMax;
 
@@ -0,0 +1,101 @@
+﻿#pragma once
+#include "prographics/prographics_export.h"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ProGraphics {
+    /**
+     * @brief 进程内共享的常驻工作线程池
+     *
+     * 线程在第一次 run() 时创建并一直保留，之后每次并行任务只需一次唤醒，
+     * 不再为每次调用创建和销毁线程。
+     * - run() 返回时所有任务都已执行完毕，调用线程也参与执行
+     * - 同一时刻只有一个 run() 使用线程池；其他线程（或任务内部嵌套）的 run() 在调用线程上串行执行
+     */
+    class PROGRAPHICS_EXPORT WorkerPool {
+    public:
+        /**
+         * @brief 进程共享的线程池，工作线程数为硬件线程数 - 1
+         */
+        static WorkerPool &instance();
+
+        /**
+         * @brief 创建独立的线程池（测试与基准用），析构时结束并回收工作线程
+         */
+        explicit WorkerPool(size_t workers);
+
+        ~WorkerPool();
+
+        /**
+         * @brief 并行度：工作线程数 + 调用线程
+         */
+        size_t concurrency() const { return m_workerCount + 1; }
+
+        /**
+         * @brief 对 [0, tasks) 中的每个 index 调用一次 task(index)
+         */
+        void run(size_t tasks, const std::function<void(size_t)> &task);
+
+    private:
+        WorkerPool(const WorkerPool &) = delete;
+
+        WorkerPool &operator=(const WorkerPool &) = delete;
+
+        void workerLoop();
+
+        // 领取并执行任务直到全部领完
+        void drain(const std::function<void(size_t)> &task, size_t tasks);
+
+        const size_t m_workerCount;
+        std::vector<std::thread> m_threads;
+        std::mutex m_runMutex; ///< 串行化 run()
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_idle;
+        const std::function<void(size_t)> *m_task = nullptr; ///< 当前任务，m_mutex 保护
+        size_t m_taskCount = 0;
+        uint64_t m_generation = 0; ///< 每次 run() 加一，唤醒等待中的工作线程
+        size_t m_active = 0; ///< 正在执行当前任务的工作线程数
+        bool m_stopping = false;
+        std::atomic<size_t> m_next{0}; ///< 下一个待领取的任务
+    };
+
+    /**
+     * @brief 将 [0, count) 切分为若干连续区间，在 pool 上并行执行 fn(begin, end)
+     *
+     * 每个区间至少 minChunk 个元素，总量不足两块时直接在当前线程执行。
+     * 调用返回时所有区间均已执行完毕。
+     */
+    template<typename Fn>
+    void parallelFor(WorkerPool &pool, size_t count, size_t minChunk, Fn &&fn) {
+        const size_t chunks = std::min(pool.concurrency(), count / std::max<size_t>(minChunk, 1));
+        if (chunks <= 1) {
+            fn(size_t{0}, count);
+            return;
+        }
+        pool.run(chunks, [&fn, chunks, count](size_t c) {
+            fn(c * count / chunks, (c + 1) * count / chunks);
+        });
+    }
+
+    /**
+     * @brief 同上，使用进程共享的线程池；不需要并行时不会创建线程池
+     */
+    template<typename Fn>
+    void parallelFor(size_t count, size_t minChunk, Fn &&fn) {
+        const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+        if (std::min(hardware, count / std::max<size_t>(minChunk, 1)) <= 1) {
+            fn(size_t{0}, count);
+            return;
+        }
+        parallelFor(WorkerPool::instance(), count, minChunk, std::forward<Fn>(fn));
+    }
+} // namespace ProGraphics
@@ -1,4 +1,5 @@
 ﻿#include "prographics/charts/base/gl_widget.h"
+#include "prographics/core/graphics/gpu_buffer_allocator.h"
 
 namespace ProGraphics {
     QSurfaceFormat chartSurfaceFormat() {
@@ -58,8 +59,16 @@ namespace ProGraphics {
     }
 
     void BaseGLWidget::paintGL() {
-        glClear(GL_COLOR_BUFFER_BIT);
-        paintGLObjects();
+        StreamingBuffer::FrameStats stats;
+        {
+            StreamingBuffer::FrameStatsScope scope(&stats);
+            glClear(GL_COLOR_BUFFER_BIT);
+            paintGLObjects();
+        }
+        m_lastFrameStats = stats;
+
+        // 帧末是共享顶点缓冲的维护点：图元在下一帧绘制前会按 epoch() 重新指向新位置
+        GpuBufferAllocator::getInstance().maintain();
     }
 
     void BaseGLWidget::resizeGL(int w, int h) { glViewport(0, 0, w, h); }
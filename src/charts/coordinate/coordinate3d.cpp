@@ -2,6 +2,7 @@
 #include "prographics/charts/coordinate/axis.h"
 #include "prographics/charts/coordinate/grid.h"
 #include "prographics/charts/base/gl_widget.h"
+#include "prographics/core/graphics/camera_uniform_buffer.h"
 #include <QMouseEvent>
 
 namespace ProGraphics {
@@ -11,8 +12,10 @@ namespace ProGraphics {
 layout (location = 0) in vec3 aPos;
 layout (location = 1) in vec4 aColor;
 
-uniform mat4 projection;
-uniform mat4 view;
+layout (std140) uniform CameraBlock {
+    mat4 projection;
+    mat4 view;
+};
 uniform float pointSize;
 out vec4 vertexColor;
 uniform mat4 model;
@@ -90,6 +93,12 @@ void main() {
       return false;
     }
 
+    // 投影与视图矩阵来自共享的 CameraBlock；模型矩阵恒为单位阵，链接后设置一次即可
+    CameraUniformBuffer::getInstance().attach(*m_program);
+    m_program->bind();
+    m_program->setUniformValue(m_program->uniformLocation("model"), QMatrix4x4());
+    m_program->release();
+
     return true;
   }
 
@@ -127,13 +136,10 @@ void main() {
                  m_backgroundcolor.alphaF());
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
     glEnable(GL_BLEND);
-    m_program->bind();
-    m_program->setUniformValue("projection", m_camera.getProjectionMatrix());
-    m_program->setUniformValue("view", m_camera.getViewMatrix());
-    QMatrix4x4 defaultModel;
-    m_program->setUniformValue("model", defaultModel);
     const QMatrix4x4 model = m_camera.getViewMatrix();
     const QMatrix4x4 projection = m_camera.getProjectionMatrix();
+    CameraUniformBuffer::getInstance().update(projection, model);
+    m_program->bind();
 
     if (m_config.axis.enabled) {
       m_axisSystem->render(projection, model);
@@ -1,6 +1,18 @@
 ﻿#include "prographics/charts/coordinate/grid.h"
 
 namespace ProGraphics {
+  namespace {
+    // 写出一条线的批处理顶点；隐藏的线保留在批处理中但完全透明，显隐切换无需重建
+    void writeLine(float *out, const Line2D &line) {
+      line.writeBatchVertices(out);
+      if (!line.isVisible()) {
+        for (int v = 0; v < line.batchVertexCount(); ++v) {
+          out[v * Primitive2DBatch::FLOATS_PER_VERTEX + 6] = 0.0f;
+        }
+      }
+    }
+  } // namespace
+
   Grid::SineWaveConfig::SineWaveConfig()
     : visible(false),
       thickness(2.0f),
@@ -78,9 +90,10 @@ namespace ProGraphics {
   void Grid::cleanup() {
     m_initialized = false;
     m_batchRenderer.reset();
-    m_xyGridLines.clear();
-    m_xzGridLines.clear();
-    m_yzGridLines.clear();
+    for (LineSet *set: lineSets()) {
+      *set = LineSet{};
+    }
+    m_batchDirty = true;
   }
 
   void Grid::render(const QMatrix4x4 &projection, const QMatrix4x4 &view) {
@@ -89,6 +102,8 @@ namespace ProGraphics {
 
     if (m_batchDirty) {
       updateBatch();
+    } else {
+      updateChangedLines();
     }
 
     m_batchRenderer->draw(projection, view);
@@ -97,18 +112,41 @@ namespace ProGraphics {
   void Grid::setConfig(const Config &config) {
     m_config = config;
     updateGrids();
-    m_batchDirty = true;
   }
 
-  void Grid::generateGridLines(std::vector<std::shared_ptr<Line2D> > &lines,
-                               const QVector3D &planeNormal,
-                               const PlaneConfig &planeConfig) {
-    if (!planeConfig.visible) {
-      lines.clear();
+  void Grid::placeLine(LineSet &lines, size_t index, const QVector3D &start, const QVector3D &end,
+                       const QVector4D &color, float lineWidth, bool visible) {
+    if (index >= lines.lines.size()) {
+      lines.lines.push_back(std::make_shared<Line2D>());
+      m_batchDirty = true;
+    }
+
+    Line2D &line = *lines.lines[index];
+    if (line.style().lineWidth != lineWidth) {
+      Primitive2DStyle style;
+      style.lineWidth = lineWidth;
+      line.setStyle(style);
+    }
+    if (line.start() == start && line.end() == end && line.color() == color && line.isVisible() == visible) {
       return;
     }
-    lines.clear();
+    line.setPoints(start, end);
+    line.setColor(color);
+    line.setVisible(visible);
+    lines.changed.push_back(index);
+  }
+
+  void Grid::truncateLines(LineSet &lines, size_t count) {
+    if (lines.lines.size() > count) {
+      lines.lines.resize(count);
+      m_batchDirty = true;
+    }
+  }
 
+  void Grid::generateGridLines(LineSet &lines,
+                               const QVector3D &planeNormal,
+                               const PlaneConfig &planeConfig) {
+    // 隐藏的平面保留线条，只在批处理中改为透明
     // 确定平面的两个方向向量
     QVector3D dir1, dir2;
     if (planeNormal == QVector3D(0, 0, 1)) {
@@ -130,8 +168,8 @@ namespace ProGraphics {
     int lineCount = static_cast<int>(m_config.size / spacing);
 
     // 生成平行于dir1方向的线
+    size_t index = 0;
     for (int i = 0; i <= lineCount; ++i) {
-      auto line = std::make_shared<Line2D>();
       float pos = i * spacing;
 
       // 判断是否为主网格线
@@ -141,21 +179,12 @@ namespace ProGraphics {
       QVector3D start = QVector3D(0, 0, 0) + dir1 * pos;
       QVector3D end = dir2 * m_config.size + dir1 * pos;
 
-      line->setPoints(start, end);
-      line->setColor(color);
-
-      Primitive2DStyle style;
-      style.lineWidth =
-          isMajor ? planeConfig.thickness : planeConfig.thickness * 0.5f;
-      line->setStyle(style);
-      line->setVisible(true);
-
-      lines.push_back(line);
+      placeLine(lines, index++, start, end, color,
+                isMajor ? planeConfig.thickness : planeConfig.thickness * 0.5f, planeConfig.visible);
     }
 
     // 生成平行于dir2方向的线
     for (int i = 0; i <= lineCount; ++i) {
-      auto line = std::make_shared<Line2D>();
       float pos = i * spacing;
 
       bool isMajor = std::abs(std::fmod(pos, 1.0f)) < 0.001f;
@@ -164,30 +193,17 @@ namespace ProGraphics {
       QVector3D start = QVector3D(0, 0, 0) + dir2 * pos;
       QVector3D end = dir1 * m_config.size + dir2 * pos;
 
-      line->setPoints(start, end);
-      line->setColor(color);
-
-      Primitive2DStyle style;
-      style.lineWidth =
-          isMajor ? planeConfig.thickness : planeConfig.thickness * 0.5f;
-      line->setStyle(style);
-      line->setVisible(true);
-
-      lines.push_back(line);
+      placeLine(lines, index++, start, end, color,
+                isMajor ? planeConfig.thickness : planeConfig.thickness * 0.5f, planeConfig.visible);
     }
+    truncateLines(lines, index);
   }
 
 
-  void Grid::generateSineWave(std::vector<std::shared_ptr<Line2D> > &lines,
+  void Grid::generateSineWave(LineSet &lines,
                               const QVector3D &planeNormal,
                               const SineWaveConfig &config,
                               float size) {
-    if (!config.visible) {
-      lines.clear();
-      return;
-    }
-
-    lines.clear();
     const int segments = 100; // 增加分段数以获得更平滑的曲线
 
     // 确定平面的两个方向向量
@@ -222,17 +238,9 @@ namespace ProGraphics {
       QVector3D start = dir1 * x1 + dir2 * s1;
       QVector3D end = dir1 * x2 + dir2 * s2;
 
-      auto line = std::make_shared<Line2D>();
-      line->setPoints(start, end);
-      line->setColor(config.color);
-
-      Primitive2DStyle style;
-      style.lineWidth = config.thickness;
-      line->setStyle(style);
-      line->setVisible(true);
-
-      lines.push_back(line);
+      placeLine(lines, static_cast<size_t>(i), start, end, config.color, config.thickness, config.visible);
     }
+    truncateLines(lines, segments);
   }
 
   void Grid::updateGrids() {
@@ -249,8 +257,14 @@ namespace ProGraphics {
     generateSineWave(m_xySineWaveLines, QVector3D(0, 0, 1), m_config.xy.sineWave, m_config.size);
     generateSineWave(m_xzSineWaveLines, QVector3D(0, 1, 0), m_config.xz.sineWave, m_config.size);
     generateSineWave(m_yzSineWaveLines, QVector3D(1, 0, 0), m_config.yz.sineWave, m_config.size);
+  }
 
-    m_batchDirty = true;
+  std::array<Grid::LineSet *, 6> Grid::lineSets() {
+    // 先网格线后正弦波，正弦波绘制在网格线之上
+    return {
+      &m_xyGridLines, &m_xzGridLines, &m_yzGridLines,
+      &m_xySineWaveLines, &m_xzSineWaveLines, &m_yzSineWaveLines
+    };
   }
 
   void Grid::updateBatch() {
@@ -258,43 +272,32 @@ namespace ProGraphics {
       return;
     m_batchRenderer->begin();
 
-    // 添加所有可见的网格线到批处理中
-    for (const auto &line: m_xyGridLines) {
-      if (line->isVisible()) {
-        line->addToRenderBatch(*m_batchRenderer);
-      }
-    }
-
-    for (const auto &line: m_xzGridLines) {
-      if (line->isVisible()) {
-        line->addToRenderBatch(*m_batchRenderer);
+    // 所有线直接写入批处理暂存区，并记下各自的图元序号
+    for (LineSet *set: lineSets()) {
+      set->items.resize(set->lines.size());
+      for (size_t i = 0; i < set->lines.size(); ++i) {
+        const Line2D &line = *set->lines[i];
+        set->items[i] = m_batchRenderer->itemCount();
+        writeLine(m_batchRenderer->append(line.batchVertexCount(), GL_LINES), line);
       }
+      set->changed.clear();
     }
 
-    for (const auto &line: m_yzGridLines) {
-      if (line->isVisible()) {
-        line->addToRenderBatch(*m_batchRenderer);
-      }
-    }
+    m_batchRenderer->end();
+    m_batchDirty = false;
+  }
 
-    // 后渲染正弦波
-    for (const auto &line: m_xySineWaveLines) {
-      if (line->isVisible()) {
-        line->addToRenderBatch(*m_batchRenderer);
-      }
-    }
-    for (const auto &line: m_xzSineWaveLines) {
-      if (line->isVisible()) {
-        line->addToRenderBatch(*m_batchRenderer);
-      }
-    }
-    for (const auto &line: m_yzSineWaveLines) {
-      if (line->isVisible()) {
-        line->addToRenderBatch(*m_batchRenderer);
+  void Grid::updateChangedLines() {
+    if (!m_batchRenderer)
+      return;
+    // 只改写变化的线，draw() 上传覆盖这些线的脏区间
+    for (LineSet *set: lineSets()) {
+      for (size_t index: set->changed) {
+        if (float *vertices = m_batchRenderer->update(set->items[index])) {
+          writeLine(vertices, *set->lines[index]);
+        }
       }
+      set->changed.clear();
     }
-
-    m_batchRenderer->end();
-    m_batchDirty = false;
   }
 } // namespace ProGraphics
@@ -1,6 +1,11 @@
-#include "prographics/charts/prpd/prpd.h"
+﻿#include "prographics/charts/prpd/prpd.h"
 #include "prographics/charts/prps/prps.h"
+#include "prographics/utils/cycle_codec.h"
 #include "prographics/utils/utils.h"
+#include "prographics/utils/worker_pool.h"
+#include <array>
+#include <cstring>
+#include <limits>
 
 namespace ProGraphics {
 
@@ -19,14 +24,16 @@ PRPDChart::PRPDChart(QWidget* parent) : Coordinate2D(parent) {
     setAxisVisible('x', false);
     setAxisVisible('y', false);
 
-    for (auto& phaseRow : m_frequencyTable) {
-        std::fill(phaseRow.begin(), phaseRow.end(), 0);
-    }
+    resizeFrequencyTable();
+    m_cycleBuffer.allocate(PRPDConstants::MAX_CYCLES, m_phasePoints, HistoryFormat::Float32);
+    m_pendingCycles.reset(PRPDConstants::QUEUE_CAPACITY, m_phasePoints);
+    setDecayHalfLife(m_decayHalfLife);
 }
 
 PRPDChart::~PRPDChart() {
     makeCurrent();
     m_pointRenderer.reset();
+    m_heatmapRenderer.reset();
     doneCurrent();
 }
 
@@ -40,14 +47,45 @@ void PRPDChart::initializeGLObjects() {
     m_pointRenderer->setStyle(pointStyle);
     m_pointRenderer->initialize();
 
-    m_cycleBuffer.data.reserve(PRPDConstants::MAX_CYCLES);
-    m_cycleBuffer.binIndices.reserve(PRPDConstants::MAX_CYCLES);
+    m_heatmapRenderer = std::make_unique<Heatmap2D>();
+    m_heatmapRenderer->initialize();
+    m_heatmapRenderer->resize(m_phasePoints, m_amplitudeBins);
+    markHeatmapRowsDirty(0, m_phasePoints);
+
     m_renderBatchMap.reserve(100);
 }
 
 void PRPDChart::paintGLObjects() {
+    drainPendingCycles();
+
+    // 合并自上一帧以来的所有量程变化，每帧最多重建一次
+    if (m_rangeDirty) {
+        m_rangeDirty = false;
+        rebuildFrequencyTable();
+    }
+    if (m_decayPointsDirty && m_renderMode == RenderMode::Points) {
+        updatePointTransformsFromFrequencyTable();
+    }
+
     Coordinate2D::paintGLObjects();
 
+    if (m_renderMode == RenderMode::Heatmap) {
+        if (!m_heatmapRenderer) {
+            return;
+        }
+        uploadHeatmapRows();
+        // 衰减模式上传的是存储值，用存储值最大值归一化，全局增益在比值中抵消
+        const float maxValue = isDecayMode() ? m_decayMax : static_cast<float>(m_maxFrequency);
+        if (maxValue <= 0.0f) {
+            return;
+        }
+        const float minValue = isDecayMode() ? maxValue * PRPDConstants::DECAY_VISIBLE_RATIO : 0.0f;
+        m_heatmapRenderer->setRect(QVector2D(mapPhaseToGL(PRPDConstants::PHASE_MIN), 0.0f),
+                                   QVector2D(mapPhaseToGL(PRPDConstants::PHASE_MAX), PRPDConstants::GL_AXIS_LENGTH));
+        m_heatmapRenderer->draw(camera().getProjectionMatrix(), camera().getViewMatrix(), maxValue, minValue);
+        return;
+    }
+
     if (!m_pointRenderer || m_renderBatchMap.empty()) {
         return;
     }
@@ -57,10 +95,10 @@ void PRPDChart::paintGLObjects() {
             continue;
 
         QVector4D color = calculateColor(batch.frequency);
-        batch.rebuildTransforms(color);
+        batch.rebuildInstances(color);
 
         m_pointRenderer->setColor(color);
-        m_pointRenderer->drawInstanced(camera().getProjectionMatrix(), camera().getViewMatrix(), batch.transforms);
+        m_pointRenderer->drawInstanced(camera().getProjectionMatrix(), camera().getViewMatrix(), batch.instances);
     }
     glPopAttrib();
 }
@@ -74,90 +112,270 @@ void PRPDChart::addCycleData(const std::vector<float>& cycleData) {
         return;
     }
 
-    bool rangeChanged = false;
-    switch (m_rangeMode) {
-        case RangeMode::Fixed:
-            break;
-        case RangeMode::Auto:
-        case RangeMode::Adaptive:
-            rangeChanged = m_dynamicRange.updateRange(cycleData);
-            break;
+    ingestBlock(cycleData.data(), 1, cycleData.size());
+    update();
+}
+
+void PRPDChart::addCycles(const float* data, size_t cycleCount, size_t stride) {
+    if (!m_acceptData || data == nullptr || cycleCount == 0) {
+        return;
+    }
+    if (stride < static_cast<size_t>(m_phasePoints)) {
+        qWarning() << "Invalid cycle stride:" << stride << "expected at least:" << m_phasePoints;
+        return;
     }
 
-    if (rangeChanged) {
-        auto [newDisplayMin, newDisplayMax] = m_dynamicRange.getDisplayRange();
-        updateAxisTicks(newDisplayMin, newDisplayMax);
-        rebuildFrequencyTable();
+    ingestBlock(data, cycleCount, stride);
+    update();
+}
+
+void PRPDChart::addCycles(std::span<const float> data) {
+    if (m_phasePoints <= 0 || data.size() % m_phasePoints != 0) {
+        qWarning() << "Invalid cycle block size:" << data.size() << "expected multiple of:" << m_phasePoints;
         return;
     }
+    addCycles(data.data(), data.size() / m_phasePoints, m_phasePoints);
+}
 
-    std::vector<BinIndex> currentBinIndices(m_phasePoints);
-    for (int i = 0; i < m_phasePoints; ++i) {
-        currentBinIndices[i] = getAmplitudeBinIndex(cycleData[i]);
+bool PRPDChart::enqueueCycle(const float* data, size_t count) {
+    if (!m_pendingCycles.push(data, count)) {
+        return false;
+    }
+    // 在 GUI 线程直接取出队列，不等下一次绘制：控件隐藏时不会绘制，只靠绘制取数据会让 Block 策略的生产者次次等到超时
+    if (!m_drainScheduled.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, [this] {
+            drainPendingCycles();
+            update();
+        }, Qt::QueuedConnection);
     }
+    return true;
+}
+
+void PRPDChart::setQueueCapacity(size_t cycles) {
+    m_pendingCycles.reset(cycles, m_phasePoints);
+}
 
-    if (m_cycleBuffer.data.size() == PRPDConstants::MAX_CYCLES) {
-        const auto& oldestBinIndices = m_cycleBuffer.binIndices[m_cycleBuffer.currentIndex];
+void PRPDChart::drainPendingCycles() {
+    m_drainScheduled.store(false, std::memory_order_release);
+
+    m_drainStaging.clear();
+    const size_t cycleCount = m_pendingCycles.popAll(m_drainStaging);
+    if (cycleCount == 0 || !m_acceptData) {
+        return;
+    }
+    ingestBlock(m_drainStaging.data(), cycleCount, m_pendingCycles.cycleSize());
+}
+
+void PRPDChart::ingestBlock(const float* data, size_t cycleCount, size_t stride) {
+    if (updateRangeFromBlock(data, cycleCount, stride)) {
+        m_rangeDirty = true;
+    }
+
+    if (isDecayMode()) {
+        // 没有原始周期可供重建，量程变化必须在分格之前重新映射；整块只映射一次
+        if (m_rangeDirty) {
+            m_rangeDirty = false;
+            rebuildFrequencyTable();
+        }
+        for (size_t i = 0; i < cycleCount; ++i) {
+            accumulateDecayed(data + i * stride);
+        }
+        return;
+    }
+
+    // 只有最后 MAX_CYCLES 个周期会留在缓冲区中，更早的周期只参与量程统计
+    const size_t first = cycleCount > PRPDConstants::MAX_CYCLES ? cycleCount - PRPDConstants::MAX_CYCLES : 0;
+    for (size_t i = first; i < cycleCount; ++i) {
+        ingestCycle(data + i * stride);
+    }
+}
+
+bool PRPDChart::updateRangeFromBlock(const float* data, size_t cycleCount, size_t stride) {
+    if (m_rangeMode == RangeMode::Fixed) {
+        return false;
+    }
+
+    auto [dataMin, dataMax] = blockMinMax(data, cycleCount, m_phasePoints, stride);
+    if (!m_dynamicRange.updateRangeFromBounds(dataMin, dataMax)) {
+        return false;
+    }
+
+    auto [newDisplayMin, newDisplayMax] = m_dynamicRange.getDisplayRange();
+    updateAxisTicks(newDisplayMin, newDisplayMax);
+    return true;
+}
+
+void PRPDChart::ingestCycle(const float* cycle) {
+    // 等待重建期间只保存原始数据，分格和统计统一在下一帧重建时完成
+    if (m_rangeDirty) {
+        m_cycleBuffer.store(m_cycleBuffer.advance(), cycle);
+        return;
+    }
+
+    // 写满时 head 指向最老的周期：先撤销它的统计，再原地覆盖
+    const int slot = m_cycleBuffer.head;
+    BinIndex* currentBinIndices = m_cycleBuffer.bins(slot);
+
+    if (m_cycleBuffer.isFull()) {
+        const BinIndex* oldestBinIndices = currentBinIndices;
 
         for (int phaseIdx = 0; phaseIdx < m_phasePoints; ++phaseIdx) {
             BinIndex binIdx = oldestBinIndices[phaseIdx];
-            if (binIdx < PRPDConstants::AMPLITUDE_BINS) {
-                int& freq = m_frequencyTable[phaseIdx][binIdx];
+            if (binIdx < m_amplitudeBins) {
+                int& freq = frequencyAt(phaseIdx, binIdx);
                 if (freq > 0) {
                     int oldFreq = freq;
-                    freq--;
-                    removePointFromBatch(phaseIdx, binIdx, oldFreq);
-                    if (freq > 0) {
-                        addPointToBatch(phaseIdx, binIdx, freq);
+                    decrementFrequency(freq);
+                    if (m_renderMode == RenderMode::Points) {
+                        removePointFromBatch(phaseIdx, binIdx, oldFreq);
+                        if (freq > 0) {
+                            addPointToBatch(phaseIdx, binIdx, freq);
+                        }
                     }
                 }
             }
         }
     }
 
-    if (m_cycleBuffer.data.size() < PRPDConstants::MAX_CYCLES) {
-        m_cycleBuffer.data.push_back(cycleData);
-        m_cycleBuffer.binIndices.push_back(currentBinIndices);
-    } else {
-        m_cycleBuffer.data[m_cycleBuffer.currentIndex]       = cycleData;
-        m_cycleBuffer.binIndices[m_cycleBuffer.currentIndex] = currentBinIndices;
-        m_cycleBuffer.currentIndex = (m_cycleBuffer.currentIndex + 1) % PRPDConstants::MAX_CYCLES;
-        m_cycleBuffer.isFull       = true;
-    }
+    m_cycleBuffer.store(slot, cycle);
+    const auto [displayMin, displayMax] = displayRange();
+    binAmplitudes(cycle, currentBinIndices, m_phasePoints, displayMin, displayMax, m_amplitudeBins);
+    m_cycleBuffer.advance();
 
     for (int phaseIdx = 0; phaseIdx < m_phasePoints; ++phaseIdx) {
         BinIndex binIdx = currentBinIndices[phaseIdx];
-        if (binIdx < PRPDConstants::AMPLITUDE_BINS) {
-            int& freq    = m_frequencyTable[phaseIdx][binIdx];
+        if (binIdx < m_amplitudeBins) {
+            int& freq    = frequencyAt(phaseIdx, binIdx);
             int  oldFreq = freq;
-            freq++;
+            incrementFrequency(freq);
 
-            if (oldFreq > 0) {
-                removePointFromBatch(phaseIdx, binIdx, oldFreq);
+            if (m_renderMode == RenderMode::Points) {
+                if (oldFreq > 0) {
+                    removePointFromBatch(phaseIdx, binIdx, oldFreq);
+                }
+                addPointToBatch(phaseIdx, binIdx, freq);
             }
-            addPointToBatch(phaseIdx, binIdx, freq);
+        }
+    }
 
-            if (freq > m_maxFrequency) {
-                m_maxFrequency = freq;
-            }
+    markHeatmapRowsDirty(0, m_phasePoints);
+}
+
+void PRPDChart::accumulateDecayed(const float* cycle) {
+    // 旧数据整体衰减等价于新数据权重整体放大：只需更新全局增益
+    m_decayGain *= m_decayGrowth;
+    if (m_decayGain > PRPDConstants::DECAY_RENORMALIZE_GAIN) {
+        renormalizeDecayGrid();
+    }
+
+    m_binScratch.resize(m_phasePoints);
+    binAmplitudes(cycle, m_binScratch.data(), m_phasePoints, m_decayGridMin, m_decayGridMax, m_amplitudeBins);
+
+    float* grid = m_decayGrid.data();
+    for (int phaseIdx = 0; phaseIdx < m_phasePoints; ++phaseIdx) {
+        float& cell = grid[static_cast<size_t>(phaseIdx) * m_amplitudeBins + m_binScratch[phaseIdx]];
+        cell += m_decayGain;
+        m_decayMax = std::max(m_decayMax, cell);
+    }
+
+    markHeatmapRowsDirty(0, m_phasePoints);
+    m_decayPointsDirty = true;
+}
+
+void PRPDChart::renormalizeDecayGrid() {
+    const float scale = 1.0f / m_decayGain;
+    const float cutoff = m_decayMax * scale * PRPDConstants::DECAY_VISIBLE_RATIO * 0.01f;
+    for (float& cell : m_decayGrid) {
+        cell *= scale;
+        if (cell < cutoff) {
+            cell = 0.0f;
         }
     }
+    m_decayMax *= scale;
+    m_decayGain = 1.0f;
+}
+
+void PRPDChart::resetDecayGrid() {
+    const auto [displayMin, displayMax] = displayRange();
+    m_decayGrid.resize(isDecayMode() ? static_cast<size_t>(m_phasePoints) * m_amplitudeBins : 0);
+    m_decayGridMin  = displayMin;
+    m_decayGridMax  = displayMax;
+    m_decayGridBins = m_amplitudeBins;
+    m_decayGain     = 1.0f;
+    m_decayMax      = 0.0f;
+    m_decayPointsDirty = true;
+    markHeatmapRowsDirty(0, m_phasePoints);
+}
+
+void PRPDChart::resizeDecayGrid() {
+    // 网格尺寸必须立即与相位点数、幅值格子数一致，不能等到下一帧：其间的 setRenderMode 等调用会按新尺寸读取网格
+    if (isDecayMode()) {
+        remapDecayGrid();
+        m_decayPointsDirty = true;
+        markHeatmapRowsDirty(0, m_phasePoints);
+    }
+}
 
-    // NOTE: 每 10 个周期重新计算最大频次，确保准确性
-    static int cycleCount = 0;
-    cycleCount            = (cycleCount + 1) % 10;
-    if (cycleCount == 0) {
-        m_maxFrequency = 0;
-        for (const auto& phaseMap : m_frequencyTable) {
-            for (int freq : phaseMap) {
-                m_maxFrequency = std::max(m_maxFrequency, freq);
-            }
+void PRPDChart::remapDecayGrid() {
+    const auto [displayMin, displayMax] = displayRange();
+    const size_t oldBins = static_cast<size_t>(m_decayGridBins);
+    if (oldBins == 0 || m_decayGrid.size() != static_cast<size_t>(m_phasePoints) * oldBins) {
+        // 相位点数变化，无法映射，重新开始统计
+        resetDecayGrid();
+        return;
+    }
+    if (oldBins == static_cast<size_t>(m_amplitudeBins) && displayMin == m_decayGridMin && displayMax == m_decayGridMax) {
+        return;
+    }
+
+    // 旧格子中心幅值在新量程下的格子索引，所有相位行共用
+    std::vector<float> centers(oldBins);
+    for (size_t b = 0; b < oldBins; ++b) {
+        centers[b] = m_decayGridMin + (static_cast<float>(b) + 0.5f) / oldBins * (m_decayGridMax - m_decayGridMin);
+    }
+    std::vector<BinIndex> target(oldBins);
+    binAmplitudes(centers.data(), target.data(), oldBins, displayMin, displayMax, m_amplitudeBins);
+
+    AlignedBuffer<float> remapped(static_cast<size_t>(m_phasePoints) * m_amplitudeBins);
+    for (int phaseIdx = 0; phaseIdx < m_phasePoints; ++phaseIdx) {
+        const float* src = m_decayGrid.data() + static_cast<size_t>(phaseIdx) * oldBins;
+        float* dst = remapped.data() + static_cast<size_t>(phaseIdx) * m_amplitudeBins;
+        for (size_t b = 0; b < oldBins; ++b) {
+            dst[target[b]] += src[b];
         }
     }
 
+    m_decayGrid     = std::move(remapped);
+    m_decayGridMin  = displayMin;
+    m_decayGridMax  = displayMax;
+    m_decayGridBins = m_amplitudeBins;
+    m_decayMax      = *std::max_element(m_decayGrid.begin(), m_decayGrid.end());
+}
+
+void PRPDChart::setAccumulationMode(AccumulationMode mode) {
+    if (m_accumulationMode == mode) {
+        return;
+    }
+    m_accumulationMode = mode;
+
+    // 衰减模式不保留原始周期，释放环形缓冲；切回滑动窗口时重新分配
+    m_cycleBuffer.allocate(isDecayMode() ? 0 : PRPDConstants::MAX_CYCLES, m_phasePoints, m_cycleBuffer.format);
+    m_binScratch.clear();
+    m_binScratch.shrink_to_fit();
+    m_renderBatchMap.clear();
+    clearFrequencyTable();
+    resetDecayGrid();
     update();
 }
 
+void PRPDChart::setDecayHalfLife(float cycles) {
+    if (!(cycles > 0.0f)) {
+        return;
+    }
+    m_decayHalfLife = cycles;
+    m_decayGrowth   = std::exp2(1.0f / cycles);
+}
+
 void PRPDChart::removePointFromBatch(int phaseIdx, BinIndex binIdx, int frequency) {
     auto it = m_renderBatchMap.find(frequency);
     if (it != m_renderBatchMap.end()) {
@@ -184,20 +402,106 @@ void PRPDChart::addPointToBatch(int phaseIdx, BinIndex binIdx, int frequency) {
 }
 
 void PRPDChart::clearFrequencyTable() {
-    for (auto& phaseRow : m_frequencyTable) {
-        std::fill(phaseRow.begin(), phaseRow.end(), 0);
-    }
+    m_frequencyTable.fill(0);
+    m_frequencyHistogram.assign(PRPDConstants::MAX_CYCLES + 1, 0);
+    m_maxFrequency = 0;
+    markHeatmapRowsDirty(0, m_phasePoints);
+}
+
+void PRPDChart::resizeFrequencyTable() {
+    m_frequencyTable.resize(static_cast<size_t>(m_phasePoints) * m_amplitudeBins);
+    m_frequencyHistogram.assign(PRPDConstants::MAX_CYCLES + 1, 0);
     m_maxFrequency = 0;
+    markHeatmapRowsDirty(0, m_phasePoints);
+}
+
+void PRPDChart::markHeatmapRowsDirty(int begin, int end) {
+    if (begin >= end) {
+        return;
+    }
+    if (m_heatmapDirtyBegin >= m_heatmapDirtyEnd) {
+        m_heatmapDirtyBegin = begin;
+        m_heatmapDirtyEnd   = end;
+    } else {
+        m_heatmapDirtyBegin = std::min(m_heatmapDirtyBegin, begin);
+        m_heatmapDirtyEnd   = std::max(m_heatmapDirtyEnd, end);
+    }
+}
+
+void PRPDChart::uploadHeatmapRows() {
+    m_heatmapRenderer->resize(m_phasePoints, m_amplitudeBins);
+
+    const int begin = std::max(m_heatmapDirtyBegin, 0);
+    const int end   = std::min(m_heatmapDirtyEnd, m_heatmapRenderer->rows());
+    m_heatmapDirtyBegin = m_heatmapDirtyEnd = 0;
+    if (begin >= end) {
+        return;
+    }
+
+    const int cols = m_amplitudeBins;
+    if (isDecayMode()) {
+        // 衰减网格本身就是 float，直接上传
+        m_heatmapRenderer->updateRows(begin, end - begin, m_decayGrid.data() + static_cast<size_t>(begin) * cols);
+        return;
+    }
+
+    m_heatmapStaging.resize(static_cast<size_t>(end - begin) * cols);
+    float* dst = m_heatmapStaging.data();
+    for (int phaseIdx = begin; phaseIdx < end; ++phaseIdx) {
+        const int* row = frequencyRow(phaseIdx);
+        for (int binIdx = 0; binIdx < cols; ++binIdx) {
+            *dst++ = static_cast<float>(row[binIdx]);
+        }
+    }
+    m_heatmapRenderer->updateRows(begin, end - begin, m_heatmapStaging.data());
+}
+
+void PRPDChart::setRenderMode(RenderMode mode) {
+    if (m_renderMode == mode) {
+        return;
+    }
+    m_renderMode = mode;
+
+    if (m_renderMode == RenderMode::Points) {
+        updatePointTransformsFromFrequencyTable();
+    } else {
+        m_renderBatchMap.clear();
+        markHeatmapRowsDirty(0, m_phasePoints);
+    }
+    update();
 }
 
 void PRPDChart::updatePointTransformsFromFrequencyTable() {
     m_renderBatchMap.clear();
+    m_decayPointsDirty = false;
+
+    if (isDecayMode()) {
+        // 衰减模式下按相对最大值量化为固定级数，以级数作为批次键
+        m_maxFrequency = m_decayMax > 0.0f ? PRPDConstants::DECAY_COLOR_LEVELS : 0;
+        if (m_decayMax <= 0.0f) {
+            return;
+        }
+        const float levelScale = PRPDConstants::DECAY_COLOR_LEVELS / m_decayMax;
+        const float cutoff     = m_decayMax * PRPDConstants::DECAY_VISIBLE_RATIO;
+        for (int phaseIdx = 0; phaseIdx < m_phasePoints; ++phaseIdx) {
+            const float* row = m_decayGrid.data() + static_cast<size_t>(phaseIdx) * m_amplitudeBins;
+            for (BinIndex binIdx = 0; binIdx < m_amplitudeBins; ++binIdx) {
+                if (row[binIdx] <= cutoff)
+                    continue;
+                const int level = std::clamp(static_cast<int>(std::ceil(row[binIdx] * levelScale)), 1,
+                                             PRPDConstants::DECAY_COLOR_LEVELS);
+                addPointToBatch(phaseIdx, binIdx, level);
+            }
+        }
+        return;
+    }
 
     for (int phaseIdx = 0; phaseIdx < m_phasePoints; ++phaseIdx) {
         float phase = static_cast<float>(phaseIdx) * (PRPDConstants::PHASE_MAX / m_phasePoints);
 
-        for (BinIndex binIdx = 0; binIdx < PRPDConstants::AMPLITUDE_BINS; ++binIdx) {
-            int frequency = m_frequencyTable[phaseIdx][binIdx];
+        const int* row = frequencyRow(phaseIdx);
+        for (BinIndex binIdx = 0; binIdx < m_amplitudeBins; ++binIdx) {
+            int frequency = row[binIdx];
             if (frequency <= 0)
                 continue;
 
@@ -231,7 +535,7 @@ void PRPDChart::setFixedRange(float min, float max) {
     m_fixedMin = m_configuredMin = min;
     m_fixedMax = m_configuredMax = max;
     updateAxisTicks(min, max);
-    rebuildFrequencyTable();
+    m_rangeDirty = true;
     update();
 }
 
@@ -244,7 +548,7 @@ void PRPDChart::setAutoRange(const DynamicRange::DynamicRangeConfig& config) {
     m_configuredMax               = currentMax;
 
     updateAxisTicks(currentMin, currentMax);
-    rebuildFrequencyTable();
+    m_rangeDirty = true;
     update();
 }
 
@@ -258,7 +562,7 @@ void PRPDChart::setAdaptiveRange(float initialMin, float initialMax, const Dynam
 
     auto [currentMin, currentMax] = m_dynamicRange.getDisplayRange();
     updateAxisTicks(currentMin, currentMax);
-    rebuildFrequencyTable();
+    m_rangeDirty = true;
     update();
 }
 
@@ -286,7 +590,7 @@ void PRPDChart::updateAutoRangeConfig(const DynamicRange::DynamicRangeConfig& co
         m_dynamicRange.setConfig(config);
         auto [currentMin, currentMax] = m_dynamicRange.getDisplayRange();
         updateAxisTicks(currentMin, currentMax);
-        rebuildFrequencyTable();
+        m_rangeDirty = true;
         update();
     }
 }
@@ -328,7 +632,7 @@ bool PRPDChart::isHardLimitsEnabled() const {
 void PRPDChart::forceUpdateRange() {
     auto [newMin, newMax] = m_dynamicRange.getDisplayRange();
     updateAxisTicks(newMin, newMax);
-    rebuildFrequencyTable();
+    m_rangeDirty = true;
     update();
 }
 
@@ -374,65 +678,75 @@ float PRPDChart::mapAmplitudeToGL(float amplitude) const {
 }
 
 void PRPDChart::rebuildFrequencyTable() {
-    clearFrequencyTable();
-
-    for (size_t i = 0; i < m_cycleBuffer.data.size(); ++i) {
-        const auto& cycle = m_cycleBuffer.data[i];
+    if (isDecayMode()) {
+        remapDecayGrid();
+        m_decayPointsDirty = true;
+        markHeatmapRowsDirty(0, m_phasePoints);
+        return;
+    }
 
-        std::vector<BinIndex> newBinIndices(m_phasePoints);
-        for (int j = 0; j < m_phasePoints; ++j) {
-            newBinIndices[j] = getAmplitudeBinIndex(cycle[j]);
-        }
+    m_frequencyTable.fill(0);
 
-        m_cycleBuffer.binIndices[i] = newBinIndices;
+    const auto [displayMin, displayMax] = displayRange();
+    const int cycleCount = m_cycleBuffer.count;
+    const size_t grain = PRPDConstants::PARALLEL_REBUILD_GRAIN / std::max(cycleCount, 1) + 1;
 
-        for (int phaseIdx = 0; phaseIdx < m_phasePoints; ++phaseIdx) {
-            BinIndex binIdx = newBinIndices[phaseIdx];
-            if (binIdx < PRPDConstants::AMPLITUDE_BINS) {
-                int& freq = m_frequencyTable[phaseIdx][binIdx];
-                freq++;
-                if (freq > m_maxFrequency) {
-                    m_maxFrequency = freq;
-                }
+    // 按相位列切分：每个线程只写自己负责的相位行和对应的分格结果，互不重叠，无需同步
+    parallelFor(static_cast<size_t>(m_phasePoints), grain, [&](size_t begin, size_t end) {
+        const size_t width = end - begin;
+        std::vector<float> decoded;
+        if (m_cycleBuffer.format != HistoryFormat::Float32) {
+            decoded.resize(width);
+        }
+        for (int i = 0; i < cycleCount; ++i) {
+            const int slot = m_cycleBuffer.slotAt(i);
+            BinIndex* bins = m_cycleBuffer.bins(slot) + begin;
+            const float* samples = m_cycleBuffer.rawCycle(slot);
+            if (samples) {
+                samples += begin;
+            } else {
+                m_cycleBuffer.load(slot, static_cast<int>(begin), static_cast<int>(width), decoded.data());
+                samples = decoded.data();
+            }
+            binAmplitudes(samples, bins, width, displayMin, displayMax, m_amplitudeBins);
+            for (size_t k = 0; k < width; ++k) {
+                ++frequencyAt(static_cast<int>(begin + k), bins[k]);
             }
         }
-    }
+    });
 
-    updatePointTransformsFromFrequencyTable();
-    update();
+    rebuildFrequencyHistogram();
+
+    if (m_renderMode == RenderMode::Points) {
+        updatePointTransformsFromFrequencyTable();
+    }
+    markHeatmapRowsDirty(0, m_phasePoints);
 }
 
-PRPDChart::BinIndex PRPDChart::getAmplitudeBinIndex(float amplitude) const {
-    float displayMin = m_fixedMin, displayMax = m_fixedMax;
+void PRPDChart::rebuildFrequencyHistogram() {
+    m_frequencyHistogram.assign(m_frequencyHistogram.size(), 0);
+    m_maxFrequency = 0;
+    for (int freq : m_frequencyTable) {
+        if (freq <= 0) {
+            continue;
+        }
+        if (freq >= static_cast<int>(m_frequencyHistogram.size())) {
+            m_frequencyHistogram.resize(freq + 1, 0);
+        }
+        ++m_frequencyHistogram[freq];
+        m_maxFrequency = std::max(m_maxFrequency, freq);
+    }
+}
 
+std::pair<float, float> PRPDChart::displayRange() const {
     switch (m_rangeMode) {
         case RangeMode::Fixed:
-            displayMin = m_fixedMin;
-            displayMax = m_fixedMax;
-            break;
+            return {m_fixedMin, m_fixedMax};
         case RangeMode::Auto:
         case RangeMode::Adaptive:
-            std::tie(displayMin, displayMax) = m_dynamicRange.getDisplayRange();
-            break;
-    }
-
-    if (amplitude <= displayMin) {
-        return 0;
-    }
-    if (amplitude >= displayMax) {
-        return PRPDConstants::AMPLITUDE_BINS - 1;
-    }
-
-    float range = displayMax - displayMin;
-    if (range < 1e-6f) {
-        return PRPDConstants::AMPLITUDE_BINS / 2;
+            return m_dynamicRange.getDisplayRange();
     }
-
-    float normalizedPos = (amplitude - displayMin) / range;
-    normalizedPos       = std::max(0.0f, std::min(0.9999f, normalizedPos));
-    int binIndex        = static_cast<int>(normalizedPos * PRPDConstants::AMPLITUDE_BINS);
-
-    return std::clamp(binIndex, 0, PRPDConstants::AMPLITUDE_BINS - 1);
+    return {m_fixedMin, m_fixedMax};
 }
 
 float PRPDChart::getBinCenterAmplitude(BinIndex binIndex) const {
@@ -449,16 +763,134 @@ float PRPDChart::getBinCenterAmplitude(BinIndex binIndex) const {
             break;
     }
 
-    if (binIndex >= PRPDConstants::AMPLITUDE_BINS) {
+    if (binIndex >= m_amplitudeBins) {
         return displayMin;
     }
 
-    float normalizedPos = (binIndex + 0.5f) / PRPDConstants::AMPLITUDE_BINS;
+    float normalizedPos = (binIndex + 0.5f) / m_amplitudeBins;
     return displayMin + normalizedPos * (displayMax - displayMin);
 }
 
 void PRPDChart::setPhasePoint(int phasePoint) {
+    if (phasePoint <= 0 || phasePoint == m_phasePoints) {
+        return;
+    }
+
+    // 已缓存的周期按新点数重采样：每个新相位点取其覆盖的原始区间内的最大幅值，保留放电峰值
+    const int oldPoints = m_phasePoints;
+    CycleBuffer resampled;
+    resampled.allocate(m_cycleBuffer.capacity, phasePoint, m_cycleBuffer.format);
+    std::vector<float> cycle(oldPoints);
+    std::vector<float> out(phasePoint);
+    for (int i = 0; i < m_cycleBuffer.count; ++i) {
+        m_cycleBuffer.load(m_cycleBuffer.slotAt(i), 0, oldPoints, cycle.data());
+        for (int j = 0; j < phasePoint; ++j) {
+            int first = static_cast<int>(static_cast<int64_t>(j) * oldPoints / phasePoint);
+            int last  = static_cast<int>(static_cast<int64_t>(j + 1) * oldPoints / phasePoint);
+            last      = std::max(last, first + 1);
+            out[j] = *std::max_element(cycle.begin() + first, cycle.begin() + last);
+        }
+        resampled.store(resampled.advance(), out.data());
+    }
+    m_cycleBuffer = std::move(resampled);
+
     m_phasePoints = phasePoint;
+    m_pendingCycles.reset(m_pendingCycles.capacity(), m_phasePoints);
+    resizeFrequencyTable();
+    resizeDecayGrid();
+    m_rangeDirty = true;
+    update();
+}
+
+void PRPDChart::setAmplitudeBins(int bins) {
+    bins = std::clamp(bins, 1, PRPDConstants::MAX_AMPLITUDE_BINS);
+    if (bins == m_amplitudeBins) {
+        return;
+    }
+
+    m_amplitudeBins = bins;
+    resizeFrequencyTable();
+    resizeDecayGrid();
+    m_rangeDirty = true;
+    update();
+}
+
+void PRPDChart::setHistoryFormat(HistoryFormat format) {
+    if (format == m_cycleBuffer.format) {
+        return;
+    }
+
+    // 已有历史解码后按新格式重新编码，分格结果不变
+    CycleBuffer converted;
+    converted.allocate(m_cycleBuffer.capacity, m_phasePoints, format);
+    std::vector<float> cycle(m_phasePoints);
+    for (int i = 0; i < m_cycleBuffer.count; ++i) {
+        const int srcSlot = m_cycleBuffer.slotAt(i);
+        m_cycleBuffer.load(srcSlot, 0, m_phasePoints, cycle.data());
+        const int dstSlot = converted.advance();
+        converted.store(dstSlot, cycle.data());
+        std::copy(m_cycleBuffer.bins(srcSlot), m_cycleBuffer.bins(srcSlot) + m_phasePoints, converted.bins(dstSlot));
+    }
+    m_cycleBuffer = std::move(converted);
+}
+
+// ==================== 历史存储编解码 ====================
+
+void PRPDChart::CycleBuffer::allocate(int cycles, int points, HistoryFormat fmt) {
+    format      = fmt;
+    capacity    = cycles;
+    phasePoints = points;
+    data.resize(static_cast<size_t>(cycles) * points * sampleBytes());
+    binIndices.resize(static_cast<size_t>(cycles) * points);
+    const size_t headerCount = fmt == HistoryFormat::Float32 ? 0 : static_cast<size_t>(cycles);
+    offsets.assign(headerCount, 0.0f);
+    scales.assign(headerCount, 0.0f);
+    clear();
+}
+
+size_t PRPDChart::CycleBuffer::sampleBytes() const {
+    switch (format) {
+        case HistoryFormat::Float32:
+            return sizeof(float);
+        case HistoryFormat::Int16:
+            return sizeof(uint16_t);
+        case HistoryFormat::LogUInt8:
+            return sizeof(uint8_t);
+    }
+    return sizeof(float);
+}
+
+void PRPDChart::CycleBuffer::store(int slot, const float* cycle) {
+    uint8_t* dst = data.data() + static_cast<size_t>(slot) * phasePoints * sampleBytes();
+    if (format == HistoryFormat::Float32) {
+        std::memcpy(dst, cycle, static_cast<size_t>(phasePoints) * sizeof(float));
+        return;
+    }
+
+    CycleCodecParams params;
+    if (format == HistoryFormat::Int16) {
+        params = encodeCycleInt16(cycle, static_cast<size_t>(phasePoints), reinterpret_cast<uint16_t*>(dst));
+    } else {
+        params = encodeCycleLogUInt8(cycle, static_cast<size_t>(phasePoints), dst);
+    }
+    offsets[slot] = params.offset;
+    scales[slot]  = params.scale;
+}
+
+void PRPDChart::CycleBuffer::load(int slot, int begin, int length, float* out) const {
+    const uint8_t* src = data.data() + (static_cast<size_t>(slot) * phasePoints + begin) * sampleBytes();
+    switch (format) {
+        case HistoryFormat::Float32:
+            std::memcpy(out, src, static_cast<size_t>(length) * sizeof(float));
+            break;
+        case HistoryFormat::Int16:
+            decodeCycleInt16(reinterpret_cast<const uint16_t*>(src), static_cast<size_t>(length),
+                             {offsets[slot], scales[slot]}, out);
+            break;
+        case HistoryFormat::LogUInt8:
+            decodeCycleLogUInt8(src, static_cast<size_t>(length), {offsets[slot], scales[slot]}, out);
+            break;
+    }
 }
 
 // ==================== 暂停/恢复 API 实现 ====================
@@ -1,11 +1,14 @@
-#include "prographics/charts/prps/prps.h"
+﻿#include "prographics/charts/prps/prps.h"
 #include <algorithm>
+#include <cmath>
+#include <limits>
 #include <random>
+#include "prographics/utils/simd_kernels.h"
 #include "prographics/utils/utils.h"
 
 namespace ProGraphics {
 
-// ==================== UpdateThread 实现 ====================
+// ==================== UpdateThread 实现（已弃用） ====================
 
 UpdateThread::UpdateThread(QObject* parent) : QThread(parent) {}
 
@@ -53,7 +56,7 @@ void UpdateThread::run() {
 
 // ==================== PRPSChart 实现 ====================
 
-PRPSChart::PRPSChart(QWidget* parent) : Coordinate3D(parent), m_updateThread(this) {
+PRPSChart::PRPSChart(QWidget* parent) : Coordinate3D(parent) {
     setSize(PRPSConstants::GL_AXIS_LENGTH);
 
     setAxisName('x', "相位", "°");
@@ -68,26 +71,34 @@ PRPSChart::PRPSChart(QWidget* parent) : Coordinate3D(parent), m_updateThread(thi
     updateAxisTicks(m_fixedMin, m_fixedMax);
     setAxisVisible('z', false);
 
-    connect(&m_updateThread, &UpdateThread::updateAnimation,
-            this, &PRPSChart::updatePRPSAnimation, Qt::QueuedConnection);
+    m_pendingCycles.reset(PRPSConstants::QUEUE_CAPACITY, m_phasePoints);
+    m_history.allocate(PRPSConstants::HISTORY_DEPTH_DEFAULT, static_cast<size_t>(m_phasePoints));
+    resetAggregate();
+    m_clock.start();
 
-    m_updateThread.start();
+    connect(this, &QOpenGLWidget::frameSwapped, this, &PRPSChart::updatePRPSAnimation);
 }
 
 PRPSChart::~PRPSChart() {
-    m_updateThread.stop();
     makeCurrent();
-    m_lineGroups.clear();
+    m_renderer.reset();
+    m_surfaceRenderer.reset();
     doneCurrent();
 }
 
-void PRPSChart::resetData() {
-    makeCurrent();
+void PRPSChart::clearHistory() {
     m_lineGroups.clear();
-    doneCurrent();
+    m_noiseFloor.clear();
+    m_history.clear();
+    m_historyView = HistoryView{};
+    resetAggregate();
+    m_renderClearPending = true;
+}
+
+void PRPSChart::resetData() {
+    clearHistory();
 
-    m_currentCycles.clear();
-    m_threshold = 0.1f;
+    m_threshold = std::numeric_limits<float>::lowest();
 
     float displayMin;
     float displayMax;
@@ -107,38 +118,89 @@ void PRPSChart::resetData() {
 
 void PRPSChart::initializeGLObjects() {
     Coordinate3D::initializeGLObjects();
+
+    m_renderer = std::make_unique<PRPSRenderer>();
+    m_renderer->initialize(static_cast<int>(PRPSConstants::MAX_LINE_GROUPS), lineCapacity());
+    m_renderer->setScrollRange(PRPSConstants::MAX_Z_POSITION, PRPSConstants::MIN_Z_POSITION,
+                               PRPSConstants::FADE_DEPTH);
+    m_surfaceRenderer = std::make_unique<PRPSSurfaceRenderer>();
+    m_surfaceRenderer->initialize(static_cast<int>(PRPSConstants::MAX_LINE_GROUPS), lineCapacity());
+    m_surfaceRenderer->setScrollRange(PRPSConstants::MAX_Z_POSITION, PRPSConstants::MIN_Z_POSITION,
+                                      PRPSConstants::FADE_DEPTH);
+    m_renderClearPending = false;
+    for (auto& group : m_lineGroups) {
+        group.uploaded = false;
+    }
 }
 
 void PRPSChart::paintGLObjects() {
+    drainPendingCycles();
+
+    // 合并自上一帧以来的所有竖线数变化，每帧最多重算一次；量程变化只影响 uniform
+    if (m_linesDirty) {
+        m_linesDirty = false;
+        recalculateLineGroups();
+        m_historyView.dirty = m_historyView.active;
+    }
+
     Coordinate3D::paintGLObjects();
 
-    if (m_lineGroups.empty()) {
+    if (!m_renderer || !m_surfaceRenderer) {
         return;
     }
+    rebaseTimeIfNeeded();
+    if (m_renderClearPending) {
+        m_renderClearPending = false;
+        m_renderer->clear();
+        m_surfaceRenderer->clear();
+    }
+
+    // 竖线数变化时实例环（或高度纹理）重新分配，所有线组需要重新写入
+    const bool surface = m_renderMode == RenderMode::Surface;
+    if ((surface ? m_surfaceRenderer->columns() : m_renderer->linesPerSlot()) != lineCapacity()) {
+        if (surface) {
+            m_surfaceRenderer->setColumns(lineCapacity());
+        } else {
+            m_renderer->setLinesPerSlot(lineCapacity());
+        }
+        for (auto& group : m_lineGroups) {
+            group.uploaded = false;
+        }
+        m_historyView.dirty = m_historyView.active;
+    }
+
+    if (m_historyView.active) {
+        // 回看期间实例环由历史切片占用，实时线组暂不上传
+        if (m_historyView.dirty) {
+            m_historyView.dirty = false;
+            uploadHistoryView();
+        }
+    } else {
+        if (m_lineGroups.empty()) {
+            return;
+        }
+        // 未上传的线组总在尾部：新追加的线组，或重算后的全部线组
+        // 槽位数据在此由历史行生成，数据接口本身不做任何 GPU 相关工作
+        for (auto it = m_lineGroups.rbegin(); it != m_lineGroups.rend() && !it->uploaded; ++it) {
+            uploadSlot(it->slot, m_history.row(it->sequence), it->birth);
+            it->uploaded = true;
+        }
+    }
 
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
-    glLineWidth(2.0f);
-
-    for (const auto& group : m_lineGroups) {
-        if (group->instancedLine && group->isActive) {
-            QMatrix4x4 model;
-            model.translate(0, 0, group->zPosition);
-
-            const float alphaRep =
-                (group->zPosition < 2.0f) ? (group->zPosition / 2.0f) : -1.0f;
-
-            group->instancedLine->drawInstanced(
-                camera().getProjectionMatrix(),
-                camera().getViewMatrix() * model,
-                group->transforms,
-                alphaRep,
-                group->instanceBufferDirty);
-            group->instanceBufferDirty = false;
-        }
+
+    if (surface) {
+        // 回看切片按时间倒序写在槽位末尾，最新切片位于最后一个槽位
+        const int head = m_historyView.active ? static_cast<int>(PRPSConstants::MAX_LINE_GROUPS) - 1
+                                              : m_lineGroups.back().slot;
+        m_surfaceRenderer->draw(camera().getProjectionMatrix(), camera().getViewMatrix(), drawParams(), head);
+    } else {
+        glLineWidth(2.0f);
+        m_renderer->draw(camera().getProjectionMatrix(), camera().getViewMatrix(), drawParams());
+        glLineWidth(1.0f);
     }
 
-    glLineWidth(1.0f);
     glDisable(GL_BLEND);
 }
 
@@ -152,143 +214,502 @@ void PRPSChart::addCycleData(const std::vector<float>& cycleData) {
         return;
     }
 
-    if (m_lineGroups.size() >= PRPSConstants::MAX_LINE_GROUPS) {
-        m_lineGroups.erase(m_lineGroups.begin());
+    addCycles(cycleData.data(), 1, cycleData.size());
+}
+
+void PRPSChart::addCycles(const float* data, size_t cycleCount, size_t stride) {
+    if (!m_acceptData || data == nullptr || cycleCount == 0) {
+        return;
+    }
+    if (stride < static_cast<size_t>(m_phasePoints)) {
+        qWarning() << "Invalid cycle stride:" << stride << "expected at least:" << m_phasePoints;
+        return;
     }
 
-    bool rangeChanged = false;
-    switch (m_rangeMode) {
-        case RangeMode::Fixed:
+    ingestBlock(data, cycleCount, stride);
+    // 动画空闲时由新数据重新启动帧循环
+    update();
+}
+
+bool PRPSChart::enqueueCycle(const float* data, size_t count) {
+    if (!m_pendingCycles.push(data, count)) {
+        return false;
+    }
+    // 在 GUI 线程直接取出队列，不等下一次绘制：控件隐藏时不会绘制，只靠绘制取数据会让 Block 策略的生产者次次等到超时
+    if (!m_drainScheduled.exchange(true, std::memory_order_acq_rel)) {
+        QMetaObject::invokeMethod(this, [this] {
+            drainPendingCycles();
+            update();
+        }, Qt::QueuedConnection);
+    }
+    return true;
+}
+
+void PRPSChart::setQueueCapacity(size_t cycles) {
+    m_pendingCycles.reset(cycles, m_phasePoints);
+}
+
+void PRPSChart::drainPendingCycles() {
+    m_drainScheduled.store(false, std::memory_order_release);
+
+    m_drainStaging.clear();
+    const size_t cycleCount = m_pendingCycles.popAll(m_drainStaging);
+    if (cycleCount == 0 || !m_acceptData) {
+        return;
+    }
+    ingestBlock(m_drainStaging.data(), cycleCount, m_pendingCycles.cycleSize());
+}
+
+void PRPSChart::ingestBlock(const float* data, size_t cycleCount, size_t stride) {
+    // 量程变化只需更新坐标轴，线高和颜色在着色器中按当前量程计算
+    updateRangeFromBlock(data, cycleCount, stride);
+
+    // 本块最终能留在历史中的线组不超过历史深度，更早的完整线组对应的周期直接跳过
+    const size_t K = static_cast<size_t>(m_cyclesPerGroup);
+    const size_t pending = static_cast<size_t>(m_aggregatedCycles);
+    const size_t produced = (pending + cycleCount) / K;
+    size_t first = 0;
+    size_t groupIndex = 0;
+    if (produced > m_history.capacity) {
+        groupIndex = produced - m_history.capacity;
+        first = groupIndex * K - pending;
+        resetAggregate();
+    }
+
+    // 只有最后 MAX_LINE_GROUPS 个线组需要生成实时线组
+    const size_t incoming = std::min(produced, PRPSConstants::MAX_LINE_GROUPS);
+    const size_t liveStart = produced - incoming;
+    const size_t total = m_lineGroups.size() + incoming;
+    if (total > PRPSConstants::MAX_LINE_GROUPS) {
+        const size_t excess = std::min(total - PRPSConstants::MAX_LINE_GROUPS, m_lineGroups.size());
+        m_lineGroups.erase(m_lineGroups.begin(), m_lineGroups.begin() + static_cast<std::ptrdiff_t>(excess));
+    }
+
+    for (size_t i = first; i < cycleCount; ++i) {
+        if (!aggregateCycle(data + i * stride)) {
+            continue;
+        }
+        updateNoiseFloor(m_history.pending());
+        const uint64_t sequence = m_history.commit();
+        if (groupIndex++ >= liveStart) {
+            appendLineGroup(sequence);
+        }
+        resetAggregate();
+    }
+}
+
+bool PRPSChart::aggregateCycle(const float* cycle) {
+    const size_t n = static_cast<size_t>(m_phasePoints);
+    float* acc = m_history.pending();
+    switch (m_aggregationMode) {
+        case AggregationMode::MaxHold:
+            accumulateMax(acc, cycle, n);
             break;
-        case RangeMode::Auto:
-        case RangeMode::Adaptive:
-            rangeChanged = m_dynamicRange.updateRange(cycleData);
+        case AggregationMode::Mean:
+            accumulateSum(acc, cycle, n);
+            break;
+        case AggregationMode::PulseCount: {
+            const float displayMin = getCurrentRange().first;
+            accumulateCount(acc, cycle, n, std::max(displayMin, m_threshold));
             break;
+        }
     }
 
-    if (rangeChanged) {
-        auto [newDisplayMin, newDisplayMax] = m_dynamicRange.getDisplayRange();
-        updateAxisTicks(newDisplayMin, newDisplayMax);
-        recalculateLineGroups();
+    if (++m_aggregatedCycles < m_cyclesPerGroup) {
+        return false;
     }
+    if (m_aggregationMode == AggregationMode::Mean && m_cyclesPerGroup > 1) {
+        const float scale = 1.0f / static_cast<float>(m_cyclesPerGroup);
+        for (size_t i = 0; i < n; ++i) {
+            acc[i] *= scale;
+        }
+    }
+    return true;
+}
 
-    m_currentCycles.push_back(cycleData);
-    processCurrentCycles();
-    m_currentCycles.clear();
+void PRPSChart::resetAggregate() {
+    // 峰值保持从 -inf 开始，全为 NaN 的相位保持 -inf 而不被绘制
+    const float initial = m_aggregationMode == AggregationMode::MaxHold ? -std::numeric_limits<float>::infinity()
+                                                                        : 0.0f;
+    float* acc = m_history.pending();
+    std::fill(acc, acc + m_history.rowSize, initial);
+    m_aggregatedCycles = 0;
 }
 
-void PRPSChart::setDisplayLineCount(int count) {
-    m_displayLineCount = count;
-    recalculateLineGroups();
+void PRPSChart::setCyclesPerGroup(int cycles) {
+    cycles = std::clamp(cycles, 1, PRPSConstants::CYCLES_PER_FRAME);
+    if (cycles == m_cyclesPerGroup) {
+        return;
+    }
+    m_cyclesPerGroup = cycles;
+    clearHistory();
+    auto [displayMin, displayMax] = getCurrentRange();
+    updateAxisTicks(displayMin, displayMax);
+    update();
 }
 
-void PRPSChart::buildLineTransformsFromCycle(const std::vector<float>& cycleData,
-                                             std::vector<Transform2D>& out) const {
-    out.clear();
-    const int N = static_cast<int>(cycleData.size());
-    if (N == 0 || N != m_phasePoints) {
+void PRPSChart::setAggregationMode(AggregationMode mode) {
+    if (mode == m_aggregationMode) {
+        return;
+    }
+    m_aggregationMode = mode;
+    clearHistory();
+    if (mode == AggregationMode::PulseCount) {
+        setAxisName('y', "脉冲数", "");
+    } else {
+        setAxisName('y', "幅值", "dBm");
+    }
+    auto [displayMin, displayMax] = getCurrentRange();
+    updateAxisTicks(displayMin, displayMax);
+    update();
+}
+
+// ==================== 历史回看 ====================
+
+void PRPSChart::HistoryRing::allocate(size_t rows, size_t points) {
+    capacity = rows;
+    rowSize  = points;
+    data.resize((rows + 1) * points);
+    clear();
+}
+
+const float* PRPSChart::HistoryRing::row(uint64_t sequence) const {
+    if (sequence >= next || next - sequence > count) {
+        return nullptr;
+    }
+    return data.data() + static_cast<size_t>(sequence % (capacity + 1)) * rowSize;
+}
+
+void PRPSChart::setHistoryDepth(size_t groups) {
+    groups = std::max(groups, PRPSConstants::MAX_LINE_GROUPS);
+    if (groups == m_history.capacity) {
         return;
     }
+    m_history.allocate(groups, static_cast<size_t>(m_phasePoints));
+    clearHistory();
+    update();
+}
 
-    const float span = m_phaseMax - m_phaseMin;
-    const int   B    = m_displayLineCount;
+void PRPSChart::setHistoryView(size_t offset, size_t span) {
+    if (m_history.count == 0) {
+        return;
+    }
+    offset = std::min(offset, m_history.count - 1);
+    m_historyView.active = true;
+    m_historyView.dirty  = true;
+    m_historyView.end    = m_history.next - offset;
+    m_historyView.span   = std::clamp<size_t>(span, 1, m_history.count - offset);
+    update();
+}
 
-    auto pushLine = [&](float phase, float amplitudeSample) {
-        const float glX = mapPhaseToGL(phase);
-        const float glY = mapAmplitudeToGL(amplitudeSample);
-        if (glY <= 0.0f) {
-            return;
+void PRPSChart::clearHistoryView() {
+    if (!m_historyView.active) {
+        return;
+    }
+    m_historyView = HistoryView{};
+    // 实例环中残留历史切片，清空后重新上传实时线组
+    for (auto& group : m_lineGroups) {
+        group.uploaded = false;
+    }
+    m_renderClearPending = true;
+    update();
+}
+
+void PRPSChart::uploadHistoryView() {
+    const size_t slotCount = PRPSConstants::MAX_LINE_GROUPS;
+    const uint64_t oldest = m_history.next - m_history.count;
+    const uint64_t end = std::min(m_historyView.end, m_history.next);
+    const uint64_t begin = std::max(end - std::min<uint64_t>(m_historyView.span, end), oldest);
+    const size_t span = end > begin ? static_cast<size_t>(end - begin) : 0;
+
+    // 切片 k 覆盖距 end 的行数区间 [bounds[k], bounds[k + 1])。
+    // 行数不超过槽位数时每片一行；否则片宽按公比 g 几何增长，首片一行，总和为 span
+    const size_t slices = std::min(span, slotCount);
+    std::vector<size_t> bounds(slices + 1);
+    for (size_t k = 0; k <= slices; ++k) {
+        bounds[k] = k;
+    }
+    if (span > slotCount) {
+        const double n = static_cast<double>(slotCount);
+        double lo = 1.0;
+        double hi = 2.0;
+        for (int iter = 0; iter < 60; ++iter) {
+            const double g = 0.5 * (lo + hi);
+            if ((std::pow(g, n) - 1.0) / (g - 1.0) < static_cast<double>(span)) {
+                lo = g;
+            } else {
+                hi = g;
+            }
         }
-        Transform2D transform;
-        transform.position = QVector2D(glX, 0.0f);
-        transform.scale    = QVector2D(1.0f, glY);
-        const float intensity = glY / PRPSConstants::GL_AXIS_LENGTH;
-        transform.color       = calculateColor(intensity);
-        out.push_back(transform);
-    };
-
-    if (B <= 0 || B >= N) {
-        if (N == 1) {
-            const float phase = 0.5f * (m_phaseMin + m_phaseMax);
-            pushLine(phase, cycleData[0]);
-            return;
+        const double g = 0.5 * (lo + hi);
+        const double total = std::pow(g, n) - 1.0;
+        for (size_t k = 1; k < slices; ++k) {
+            const auto ideal = static_cast<size_t>(std::llround(span * (std::pow(g, static_cast<double>(k)) - 1.0) / total));
+            bounds[k] = std::clamp(ideal, bounds[k - 1] + 1, span - (slices - k));
         }
-        for (int i = 0; i < N; ++i) {
-            const float phase = static_cast<float>(i) / static_cast<float>(N - 1) * m_phaseMax;
-            pushLine(phase, cycleData[i]);
+        bounds[slices] = span;
+    }
+
+    const float step = (PRPSConstants::MAX_Z_POSITION - PRPSConstants::MIN_Z_POSITION) / static_cast<float>(slotCount);
+    m_sliceScratch.resize(m_history.rowSize);
+    for (size_t k = 0; k < slotCount; ++k) {
+        const float* slice = nullptr;
+        if (k < slices) {
+            std::fill(m_sliceScratch.begin(), m_sliceScratch.end(), -std::numeric_limits<float>::infinity());
+            for (size_t age = bounds[k]; age < bounds[k + 1]; ++age) {
+                accumulateMax(m_sliceScratch.data(), m_history.row(end - 1 - age), m_history.rowSize);
+            }
+            slice = m_sliceScratch.data();
         }
+        // 静态绘制时 z = startZ + birth，最新的切片在最后方；
+        // 槽位随时间倒序分配，使曲面模式下相邻槽位即相邻切片
+        uploadSlot(static_cast<int>(slotCount - 1 - k), slice, -step * static_cast<float>(k));
+    }
+}
+
+void PRPSChart::addCycles(std::span<const float> data) {
+    if (m_phasePoints <= 0 || data.size() % m_phasePoints != 0) {
+        qWarning() << "Invalid cycle block size:" << data.size() << "expected multiple of:" << m_phasePoints;
         return;
     }
+    addCycles(data.data(), data.size() / m_phasePoints, m_phasePoints);
+}
 
-    for (int b = 0; b < B; ++b) {
-        const int i0 = b * N / B;
-        const int i1 = (b + 1) * N / B;
-        if (i0 >= i1) {
-            continue;
-        }
-        float peak = cycleData[static_cast<size_t>(i0)];
-        for (int i = i0 + 1; i < i1; ++i) {
-            peak = std::max(peak, cycleData[static_cast<size_t>(i)]);
-        }
-        const float phase = m_phaseMin + (static_cast<float>(b) + 0.5f) * span / static_cast<float>(B);
-        pushLine(phase, peak);
+bool PRPSChart::updateRangeFromBlock(const float* data, size_t cycleCount, size_t stride) {
+    if (m_rangeMode == RangeMode::Fixed) {
+        return false;
+    }
+
+    auto [dataMin, dataMax] = blockMinMax(data, cycleCount, m_phasePoints, stride);
+    if (!m_dynamicRange.updateRangeFromBounds(dataMin, dataMax)) {
+        return false;
     }
+
+    auto [newDisplayMin, newDisplayMax] = m_dynamicRange.getDisplayRange();
+    updateAxisTicks(newDisplayMin, newDisplayMax);
+    return true;
 }
 
-void PRPSChart::processCurrentCycles() {
-    makeCurrent();
+void PRPSChart::setDisplayLineCount(int count) {
+    m_displayLineCount = count;
+    m_linesDirty = true;
+    update();
+}
 
-    auto newGroup = std::make_unique<LineGroup>();
-    const auto& cycleData = m_currentCycles.front();
-    newGroup->amplitudes  = cycleData;
+void PRPSChart::setRenderMode(RenderMode mode) {
+    if (mode == m_renderMode) {
+        return;
+    }
+    m_renderMode = mode;
+    m_linesDirty = true;
+    // 另一个渲染器中可能残留上次使用时的槽位
+    m_renderClearPending = true;
+    update();
+}
 
-    newGroup->instancedLine = std::make_unique<Line2D>(
-        QVector3D(0.0f, 0.0f, 0.0f),
-        QVector3D(0.0f, 1.0f, 0.0f),
-        QVector4D(1.0f, 1.0f, 1.0f, 1.0f));
+void PRPSChart::setLineStyle(LineStyle style) {
+    if (style == m_lineStyle) {
+        return;
+    }
+    m_lineStyle = style;
+    m_linesDirty = true;
+    update();
+}
 
-    const int cap = (m_displayLineCount > 0 && m_displayLineCount < m_phasePoints) ? m_displayLineCount : m_phasePoints;
-    newGroup->transforms.reserve(static_cast<size_t>(cap));
+int PRPSChart::lineCapacity() const {
+    return (m_displayLineCount > 0 && m_displayLineCount < m_phasePoints) ? m_displayLineCount : m_phasePoints;
+}
 
-    buildLineTransformsFromCycle(cycleData, newGroup->transforms);
+PRPSRenderer::DrawParams PRPSChart::drawParams() const {
+    PRPSRenderer::DrawParams params;
+    if (m_historyView.active) {
+        // 回看切片的诞生时间即相对 startZ 的固定偏移
+        params.time  = 0.0f;
+        params.speed = 1.0f;
+    } else {
+        params.time  = static_cast<float>(animationTime() - m_timeBase);
+        params.speed = m_scrollSpeed;
+    }
 
-    newGroup->instancedLine->initialize();
-    m_lineGroups.push_back(std::move(newGroup));
-    doneCurrent();
+    // 逐点模式下采样点均匀铺满相位轴；分桶模式下竖线位于桶中心
+    const int lines = lineCapacity();
+    if (lines < m_phasePoints || m_phasePoints == 1) {
+        params.phaseScale  = PRPSConstants::GL_AXIS_LENGTH / static_cast<float>(lines);
+        params.phaseOffset = 0.5f;
+    } else {
+        params.phaseScale  = PRPSConstants::GL_AXIS_LENGTH / static_cast<float>(m_phasePoints - 1);
+        params.phaseOffset = 0.0f;
+    }
+
+    if (m_aggregationMode == AggregationMode::PulseCount) {
+        // 计数为 0 的相位不绘制，满 K 次为满高
+        params.amplitudeMin = 0.0f;
+        params.amplitudeMax = static_cast<float>(m_cyclesPerGroup);
+    } else {
+        std::tie(params.amplitudeMin, params.amplitudeMax) = getCurrentRange();
+    }
+    params.height    = PRPSConstants::GL_AXIS_LENGTH;
+    return params;
 }
 
-void PRPSChart::updatePRPSAnimation() {
-    bool needCleanup = false;
+void PRPSChart::setThreshold(float threshold) {
+    m_threshold  = threshold;
+    m_linesDirty = true;
+    update();
+}
 
-    for (auto& group : m_lineGroups) {
-        group->zPosition -= m_prpsAnimationSpeed;
+void PRPSChart::setNoiseFloorConfig(const NoiseFloorConfig& config) {
+    m_noiseFloorConfig          = config;
+    m_noiseFloorConfig.quantile = std::clamp(config.quantile, 0.0f, 1.0f);
+    m_noiseFloorConfig.step     = std::max(config.step, 0.0f);
+    if (!config.enabled) {
+        m_noiseFloor.clear();
+    }
+    m_linesDirty = true;
+    update();
+}
+
+void PRPSChart::updateNoiseFloor(const float* row) {
+    if (!m_noiseFloorConfig.enabled || m_aggregationMode == AggregationMode::PulseCount) {
+        return;
+    }
 
-        if (group->zPosition <= PRPSConstants::MIN_Z_POSITION) {
-            group->isActive = false;
-            needCleanup     = true;
+    const size_t n = static_cast<size_t>(m_phasePoints);
+    if (m_noiseFloor.size() != n) {
+        // 以第一个线组初始化；无效采样从显示下限开始跟踪
+        const float displayMin = getCurrentRange().first;
+        m_noiseFloor.resize(n);
+        for (size_t i = 0; i < n; ++i) {
+            m_noiseFloor[i] = std::isfinite(row[i]) ? row[i] : displayMin;
         }
+        return;
     }
+    trackQuantile(m_noiseFloor.data(), row, n, m_noiseFloorConfig.quantile, m_noiseFloorConfig.step);
+}
 
-    if (needCleanup) {
-        cleanupInactiveGroups();
+size_t PRPSChart::reduceCycleToBuckets(const float* cycleData) {
+    const int N = m_phasePoints;
+    if (cycleData == nullptr || N <= 0) {
+        return 0;
     }
 
+    // 一次扫描得到每个桶的最小值、最大值及最大值所在相位；逐点绘制即每桶一个采样
+    const size_t B = static_cast<size_t>(std::min(lineCapacity(), N));
+    const bool envelope = m_renderMode == RenderMode::Lines && m_lineStyle == LineStyle::Envelope;
+    const bool useFloor = m_aggregationMode != AggregationMode::PulseCount && m_noiseFloorConfig.enabled &&
+                          m_noiseFloor.size() == static_cast<size_t>(N);
+    m_bucketMin.resize(B);
+    m_bucketMax.resize(B);
+    m_bucketArgMax.resize(B);
+    m_gateScratch.resize(B);
+    decimateMinMax(cycleData, static_cast<size_t>(N), B, envelope ? m_bucketMin.data() : nullptr,
+                   m_bucketMax.data(), useFloor ? m_bucketArgMax.data() : nullptr);
+
+    // 门限只作用于桶峰值：被滤除的桶置为 -inf
+    if (m_aggregationMode == AggregationMode::PulseCount) {
+        // 计数模式的阈值已在计数时使用，这里只滤除计数为 0 的相位
+        gateSamples(m_bucketMax.data(), nullptr, 0.0f, 0.5f, m_gateScratch.data(), B);
+    } else {
+        if (useFloor) {
+            m_bucketFloor.resize(B);
+            for (size_t b = 0; b < B; ++b) {
+                m_bucketFloor[b] = m_noiseFloor[m_bucketArgMax[b]];
+            }
+        }
+        gateSamples(m_bucketMax.data(), useFloor ? m_bucketFloor.data() : nullptr, m_noiseFloorConfig.margin,
+                    m_threshold, m_gateScratch.data(), B);
+    }
+    return B;
+}
+
+void PRPSChart::buildLineInstancesFromCycle(const float* cycleData,
+                                            std::vector<PRPSRenderer::LineInstance>& out) {
+    out.clear();
+    const size_t B = reduceCycleToBuckets(cycleData);
+    const bool envelope = m_lineStyle == LineStyle::Envelope;
+    for (size_t b = 0; b < B; ++b) {
+        if (m_gateScratch[b] == -std::numeric_limits<float>::infinity()) {
+            continue;
+        }
+        PRPSRenderer::LineInstance line;
+        line.phaseIndex = static_cast<float>(b);
+        line.amplitude  = m_gateScratch[b];
+        if (envelope) {
+            line.low = m_bucketMin[b];
+        }
+        out.push_back(line);
+    }
+}
+
+void PRPSChart::uploadSlot(int slot, const float* cycleData, float birth) {
+    if (m_renderMode == RenderMode::Lines) {
+        buildLineInstancesFromCycle(cycleData, m_slotInstances);
+        m_renderer->writeSlot(slot, m_slotInstances.data(), static_cast<int>(m_slotInstances.size()), birth);
+        return;
+    }
+    // 被滤除的桶保留为 -inf，在着色器中贴底
+    const size_t B = reduceCycleToBuckets(cycleData);
+    m_surfaceRenderer->writeRow(slot, m_gateScratch.data(), static_cast<int>(B), birth);
+}
+
+void PRPSChart::appendLineGroup(uint64_t sequence) {
+    LineGroup group;
+    group.sequence = sequence;
+    group.birth = static_cast<float>(animationTime() - m_timeBase);
+    // 线组按先进先出淘汰且总数不超过槽位数，顺序分配的槽位不会与存活线组冲突
+    group.slot = static_cast<int>(m_nextSlot++ % PRPSConstants::MAX_LINE_GROUPS);
+    // 槽位数据在下一次绘制时由历史行生成
+    m_lineGroups.push_back(group);
+}
+
+void PRPSChart::updatePRPSAnimation() {
+    // 空闲时不再请求下一帧，帧循环停止，直到新数据或 resume() 重新触发；回看期间画面静止
+    if (m_paused || m_historyView.active || m_lineGroups.empty()) {
+        return;
+    }
+
+    // 滚动位置由着色器根据动画时间计算，这里只清理滚出范围的线组；
+    // 最后一个线组移除后仍需再绘制一帧以清除画面
+    cleanupInactiveGroups();
     update();
 }
 
+double PRPSChart::animationTime() const {
+    return m_clockOffset + (m_clock.isValid() ? static_cast<double>(m_clock.nsecsElapsed()) * 1e-9 : 0.0);
+}
+
+void PRPSChart::setUpdateInterval(int intervalMs) {
+    m_updateIntervalMs = std::max(intervalMs, 1);
+    m_scrollSpeed      = PRPSConstants::SCROLL_STEP * 1000.0f / static_cast<float>(m_updateIntervalMs);
+}
+
 void PRPSChart::cleanupInactiveGroups() {
-    makeCurrent();
+    const float lifetime = (PRPSConstants::MAX_Z_POSITION - PRPSConstants::MIN_Z_POSITION) / m_scrollSpeed;
+    const float now      = static_cast<float>(animationTime() - m_timeBase);
 
-    auto it = std::remove_if(m_lineGroups.begin(), m_lineGroups.end(),
-        [](const std::unique_ptr<LineGroup>& group) {
-            return !group->isActive;
+    // 线组按诞生顺序排列，只需从头部找到第一个仍在范围内的线组
+    auto it = std::find_if(m_lineGroups.begin(), m_lineGroups.end(),
+        [&](const LineGroup& group) {
+            return now - group.birth < lifetime;
         });
+    m_lineGroups.erase(m_lineGroups.begin(), it);
+}
 
-    if (it != m_lineGroups.end()) {
-        m_lineGroups.erase(it, m_lineGroups.end());
+void PRPSChart::rebaseTimeIfNeeded() {
+    const double now = animationTime();
+    if (now - m_timeBase < PRPSConstants::TIME_REBASE_SECONDS) {
+        return;
     }
 
-    doneCurrent();
+    const float delta = static_cast<float>(now - m_timeBase);
+    m_timeBase = now;
+    for (auto& group : m_lineGroups) {
+        group.birth -= delta;
+        group.uploaded = false;
+    }
+    m_historyView.dirty = m_historyView.active;
+    // 环中残留的旧实例诞生时间已不可比较，整体清空后重新上传
+    m_renderClearPending = true;
 }
 
 // ==================== 量程设置 API 实现 ====================
@@ -298,7 +719,6 @@ void PRPSChart::setFixedRange(float min, float max) {
     m_fixedMin = m_configuredMin = min;
     m_fixedMax = m_configuredMax = max;
     updateAxisTicks(min, max);
-    recalculateLineGroups();
     update();
 }
 
@@ -311,7 +731,6 @@ void PRPSChart::setAutoRange(const DynamicRange::DynamicRangeConfig& config) {
     m_configuredMax               = currentMax;
 
     updateAxisTicks(currentMin, currentMax);
-    recalculateLineGroups();
     update();
 }
 
@@ -325,7 +744,6 @@ void PRPSChart::setAdaptiveRange(float initialMin, float initialMax, const Dynam
 
     auto [currentMin, currentMax] = m_dynamicRange.getDisplayRange();
     updateAxisTicks(currentMin, currentMax);
-    recalculateLineGroups();
     update();
 }
 
@@ -353,7 +771,6 @@ void PRPSChart::updateAutoRangeConfig(const DynamicRange::DynamicRangeConfig& co
         m_dynamicRange.setConfig(config);
         auto [currentMin, currentMax] = m_dynamicRange.getDisplayRange();
         updateAxisTicks(currentMin, currentMax);
-        recalculateLineGroups();
         update();
     }
 }
@@ -395,11 +812,14 @@ bool PRPSChart::isHardLimitsEnabled() const {
 void PRPSChart::forceUpdateRange() {
     auto [newMin, newMax] = m_dynamicRange.getDisplayRange();
     updateAxisTicks(newMin, newMax);
-    recalculateLineGroups();
     update();
 }
 
 void PRPSChart::updateAxisTicks(float min, float max) {
+    if (m_aggregationMode == AggregationMode::PulseCount) {
+        min = 0.0f;
+        max = static_cast<float>(m_cyclesPerGroup);
+    }
     int targetTicks = m_dynamicRange.getConfig().targetTickCount;
     float step = calculateNiceTickStep(max - min, targetTicks);
     setTicksRange('y', min, max, step);
@@ -413,7 +833,16 @@ void PRPSChart::setPhaseRange(float min, float max) {
 }
 
 void PRPSChart::setPhasePoint(int phasePoint) {
+    if (phasePoint <= 0 || phasePoint == m_phasePoints) {
+        return;
+    }
+
     m_phasePoints = phasePoint;
+    m_pendingCycles.reset(m_pendingCycles.capacity(), m_phasePoints);
+    // 历史行长度随相位点数变化，旧数据无法沿用
+    m_history.allocate(m_history.capacity, static_cast<size_t>(m_phasePoints));
+    clearHistory();
+    update();
 }
 
 float PRPSChart::mapPhaseToGL(float phase) const {
@@ -466,33 +895,29 @@ float PRPSChart::mapGLToAmplitude(float glY) const {
 }
 
 void PRPSChart::recalculateLineGroups() {
-    makeCurrent();
-
-    const int cap = (m_displayLineCount > 0 && m_displayLineCount < m_phasePoints) ? m_displayLineCount : m_phasePoints;
-
     for (auto& group : m_lineGroups) {
-        group->transforms.clear();
-        group->transforms.reserve(static_cast<size_t>(cap));
-        buildLineTransformsFromCycle(group->amplitudes, group->transforms);
-        group->instanceBufferDirty = true;
+        group.uploaded = false;
     }
-
-    doneCurrent();
-    update();
 }
 
 // ==================== 暂停/恢复 API 实现 ====================
 
 void PRPSChart::pause(bool blockNewData) {
+    if (!m_paused) {
+        m_clockOffset = animationTime();
+        m_clock.invalidate();
+    }
     m_paused = true;
-    m_updateThread.setPaused(true);
     m_acceptData = !blockNewData;
 }
 
 void PRPSChart::resume() {
+    if (m_paused) {
+        m_clock.start();
+    }
     m_paused = false;
-    m_updateThread.setPaused(false);
     m_acceptData = true;
+    update();
 }
 
 void PRPSChart::togglePause() {
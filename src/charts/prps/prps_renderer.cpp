@@ -0,0 +1,212 @@
+﻿#define GL_SILENCE_DEPRECATION
+#include "prographics/charts/prps/prps_renderer.h"
+#include "prographics/core/graphics/camera_uniform_buffer.h"
+#include "prographics/core/graphics/shader_colormap.h"
+#include <QDebug>
+#include <algorithm>
+#include <string>
+
+namespace ProGraphics {
+
+PRPSRenderer::PRPSRenderer() {
+    initializeOpenGLFunctions();
+}
+
+PRPSRenderer::~PRPSRenderer() {
+    destroy();
+}
+
+void PRPSRenderer::initializeShader() {
+    m_program = std::make_unique<QOpenGLShaderProgram>();
+    m_uniforms = UniformLocations{};
+
+    // z = 诞生位置 - 存活时间 * 速度；线高与颜色由显示量程决定，颜色映射与 calculateColor 一致。
+    // 竖线从 low（-inf 即底面）画到 amplitude。槽位数编译进着色器，槽位内超出有效实例数的实例被剔除
+    const std::string vertexShaderSource = R"(
+            #version 410 core
+            #define SLOT_COUNT )" + std::to_string(m_slotCount) + R"(
+            layout (location = 0) in vec4 iLine;   // phaseIndex, amplitude, birth, low
+
+            layout (std140) uniform CameraBlock {
+                mat4 projection;
+                mat4 view;
+            };
+            uniform float uTime;
+            uniform float uSpeed;
+            uniform vec3 uScroll;   // startZ, endZ, fadeDepth
+            uniform vec2 uPhase;    // scale, offset
+            uniform vec2 uRange;    // min, max
+            uniform float uHeight;
+            uniform int uLinesPerSlot;
+            uniform int uSlotLines[SLOT_COUNT];
+
+            out vec4 vColor;
+        )" + INTENSITY_COLORMAP_GLSL + R"(
+            void main() {
+                int slot = gl_InstanceID / uLinesPerSlot;
+                bool unused = gl_InstanceID - slot * uLinesPerSlot >= uSlotLines[slot];
+                float z = uScroll.x - (uTime - iLine.z) * uSpeed;
+                float amplitude = iLine.y;
+                if (unused || amplitude <= uRange.x || z <= uScroll.y) {
+                    // 不可见实例移到裁剪空间之外
+                    gl_Position = vec4(2.0, 2.0, 2.0, 1.0);
+                    vColor = vec4(0.0);
+                    return;
+                }
+
+                float intensity = min((amplitude - uRange.x) / (uRange.y - uRange.x), 1.0);
+                float base = clamp((iLine.w - uRange.x) / (uRange.y - uRange.x), 0.0, intensity);
+                float x = (iLine.x + uPhase.y) * uPhase.x;
+                float y = mix(base, intensity, float(gl_VertexID)) * uHeight;
+                gl_Position = projection * view * vec4(x, y, min(z, uScroll.x), 1.0);
+
+                float alpha = intensity < 0.3 ? intensity / 0.3 * 0.7 + 0.3 : 1.0;
+                vColor = vec4(intensityColor(intensity, 1.0), alpha);
+                if (z < uScroll.z) {
+                    vColor.a = z / uScroll.z;
+                }
+            }
+        )";
+
+    const char* fragmentShaderSource = R"(
+            #version 410 core
+            in vec4 vColor;
+            out vec4 FragColor;
+
+            void main() {
+                FragColor = vColor;
+            }
+        )";
+
+    if (!m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShaderSource.c_str())) {
+        qDebug() << "PRPS vertex shader compilation failed:" << m_program->log();
+        return;
+    }
+    if (!m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShaderSource)) {
+        qDebug() << "PRPS fragment shader compilation failed:" << m_program->log();
+        return;
+    }
+    if (!m_program->link()) {
+        qDebug() << "PRPS shader program linking failed:" << m_program->log();
+        return;
+    }
+
+    CameraUniformBuffer::getInstance().attach(*m_program);
+    m_uniforms.time = m_program->uniformLocation("uTime");
+    m_uniforms.speed = m_program->uniformLocation("uSpeed");
+    m_uniforms.scroll = m_program->uniformLocation("uScroll");
+    m_uniforms.phase = m_program->uniformLocation("uPhase");
+    m_uniforms.range = m_program->uniformLocation("uRange");
+    m_uniforms.height = m_program->uniformLocation("uHeight");
+    m_uniforms.linesPerSlot = m_program->uniformLocation("uLinesPerSlot");
+    m_uniforms.slotLines = m_program->uniformLocation("uSlotLines");
+}
+
+void PRPSRenderer::initialize(int slotCount, int linesPerSlot) {
+    m_slotCount    = std::max(slotCount, 1);
+    m_linesPerSlot = std::max(linesPerSlot, 1);
+
+    initializeShader();
+
+    m_vao.create();
+    m_vao.bind();
+    glGenBuffers(1, &m_instanceBuffer);
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, sizeof(LineInstance), nullptr);
+    glVertexAttribDivisor(0, 1);
+
+    m_vao.release();
+    allocateInstanceBuffer();
+}
+
+void PRPSRenderer::allocateInstanceBuffer() {
+    // 有效实例数全部为 0，缓冲内容无需初始化
+    const size_t instances = static_cast<size_t>(m_slotCount) * m_linesPerSlot;
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+    glBufferData(GL_ARRAY_BUFFER, static_cast<GLsizeiptr>(instances * sizeof(LineInstance)), nullptr,
+                 GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+    m_staging.resize(m_linesPerSlot);
+    m_slotLines.assign(m_slotCount, 0);
+}
+
+void PRPSRenderer::setLinesPerSlot(int linesPerSlot) {
+    linesPerSlot = std::max(linesPerSlot, 1);
+    if (linesPerSlot == m_linesPerSlot || !m_instanceBuffer) {
+        return;
+    }
+    m_linesPerSlot = linesPerSlot;
+    allocateInstanceBuffer();
+}
+
+void PRPSRenderer::writeSlot(int slot, const LineInstance* lines, int count, float birth) {
+    if (!m_instanceBuffer || slot < 0 || slot >= m_slotCount) {
+        return;
+    }
+
+    count = std::clamp(count, 0, m_linesPerSlot);
+    m_slotLines[slot] = count;
+    if (count == 0) {
+        return;
+    }
+
+    std::copy(lines, lines + count, m_staging.begin());
+    for (int i = 0; i < count; ++i) {
+        m_staging[i].birth = birth;
+    }
+
+    const GLsizeiptr slotBytes = static_cast<GLsizeiptr>(m_linesPerSlot * sizeof(LineInstance));
+    glBindBuffer(GL_ARRAY_BUFFER, m_instanceBuffer);
+    glBufferSubData(GL_ARRAY_BUFFER, slot * slotBytes, static_cast<GLsizeiptr>(count * sizeof(LineInstance)),
+                    m_staging.data());
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
+}
+
+void PRPSRenderer::clear() {
+    std::fill(m_slotLines.begin(), m_slotLines.end(), 0);
+}
+
+void PRPSRenderer::setScrollRange(float startZ, float endZ, float fadeDepth) {
+    m_startZ    = startZ;
+    m_endZ      = endZ;
+    m_fadeDepth = fadeDepth;
+}
+
+void PRPSRenderer::draw(const QMatrix4x4& projection, const QMatrix4x4& view, const DrawParams& params) {
+    if (!m_program || !m_instanceBuffer) {
+        return;
+    }
+
+    CameraUniformBuffer::getInstance().update(projection, view);
+
+    m_program->bind();
+    m_program->setUniformValue(m_uniforms.time, params.time);
+    m_program->setUniformValue(m_uniforms.speed, params.speed);
+    m_program->setUniformValue(m_uniforms.scroll, QVector3D(m_startZ, m_endZ, m_fadeDepth));
+    m_program->setUniformValue(m_uniforms.phase, QVector2D(params.phaseScale, params.phaseOffset));
+    m_program->setUniformValue(m_uniforms.range, QVector2D(params.amplitudeMin, params.amplitudeMax));
+    m_program->setUniformValue(m_uniforms.height, params.height);
+    m_program->setUniformValue(m_uniforms.linesPerSlot, m_linesPerSlot);
+    m_program->setUniformValueArray(m_uniforms.slotLines, m_slotLines.data(), m_slotCount);
+
+    m_vao.bind();
+    glDrawArraysInstanced(GL_LINES, 0, 2, m_slotCount * m_linesPerSlot);
+    m_vao.release();
+
+    m_program->release();
+}
+
+void PRPSRenderer::destroy() {
+    if (m_instanceBuffer) {
+        glDeleteBuffers(1, &m_instanceBuffer);
+        m_instanceBuffer = 0;
+    }
+    if (m_vao.isCreated()) {
+        m_vao.destroy();
+    }
+    m_program.reset();
+}
+
+} // namespace ProGraphics
@@ -0,0 +1,266 @@
+﻿#define GL_SILENCE_DEPRECATION
+#include "prographics/charts/prps/prps_surface_renderer.h"
+#include "prographics/core/graphics/camera_uniform_buffer.h"
+#include "prographics/core/graphics/shader_colormap.h"
+#include <QDebug>
+#include <QVector2D>
+#include <QVector3D>
+#include <algorithm>
+#include <limits>
+#include <string>
+
+namespace ProGraphics {
+
+PRPSSurfaceRenderer::PRPSSurfaceRenderer() {
+    initializeOpenGLFunctions();
+}
+
+PRPSSurfaceRenderer::~PRPSSurfaceRenderer() {
+    destroy();
+}
+
+void PRPSSurfaceRenderer::initializeShader() {
+    m_program = std::make_unique<QOpenGLShaderProgram>();
+    m_uniforms = UniformLocations{};
+
+    // 网格行 row 从最旧到最新排列，对应槽位 (head + 1 + row) % SLOT_COUNT；
+    // 空槽位的顶点 vValid 为 0，与其相连的三角形在片段着色器中整体丢弃
+    const std::string vertexShaderSource = R"(
+            #version 410 core
+            #define SLOT_COUNT )" + std::to_string(m_slotCount) + R"(
+
+            layout (std140) uniform CameraBlock {
+                mat4 projection;
+                mat4 view;
+            };
+            uniform float uTime;
+            uniform float uSpeed;
+            uniform vec3 uScroll;   // startZ, endZ, fadeDepth
+            uniform vec2 uPhase;    // scale, offset
+            uniform vec2 uRange;    // min, max
+            uniform float uHeight;
+            uniform int uColumns;
+            uniform int uHead;
+            uniform int uSlotValid[SLOT_COUNT];
+            uniform float uSlotBirth[SLOT_COUNT];
+            uniform sampler2D uHeights;   // 宽 = 列数，高 = 槽位数
+
+            out float vIntensity;
+            out float vZ;
+            out float vValid;
+
+            void main() {
+                int row = gl_VertexID / uColumns;
+                int column = gl_VertexID - row * uColumns;
+                int slot = (uHead + 1 + row) % SLOT_COUNT;
+
+                float amplitude = texelFetch(uHeights, ivec2(column, slot), 0).r;
+                float intensity = clamp((amplitude - uRange.x) / (uRange.y - uRange.x), 0.0, 1.0);
+                float z = uScroll.x - (uTime - uSlotBirth[slot]) * uSpeed;
+                float x = (float(column) + uPhase.y) * uPhase.x;
+
+                vIntensity = intensity;
+                vZ = z;
+                vValid = float(uSlotValid[slot]);
+                gl_Position = projection * view * vec4(x, intensity * uHeight, min(z, uScroll.x), 1.0);
+            }
+        )";
+
+    // 颜色映射与 PRPSRenderer 共用，按片段插值后的强度计算
+    const std::string fragmentShaderSource = std::string(R"(
+            #version 410 core
+            in float vIntensity;
+            in float vZ;
+            in float vValid;
+            out vec4 FragColor;
+
+            uniform vec3 uScroll;
+        )") + INTENSITY_COLORMAP_GLSL + R"(
+            void main() {
+                if (vValid < 0.999 || vZ <= uScroll.y) {
+                    discard;
+                }
+                float alpha = vIntensity < 0.3 ? vIntensity / 0.3 * 0.7 + 0.3 : 1.0;
+                FragColor = vec4(intensityColor(vIntensity, 1.0), alpha);
+                if (vZ < uScroll.z) {
+                    FragColor.a = vZ / uScroll.z;
+                }
+            }
+        )";
+
+    if (!m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShaderSource.c_str())) {
+        qDebug() << "PRPS surface vertex shader compilation failed:" << m_program->log();
+        return;
+    }
+    if (!m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShaderSource.c_str())) {
+        qDebug() << "PRPS surface fragment shader compilation failed:" << m_program->log();
+        return;
+    }
+    if (!m_program->link()) {
+        qDebug() << "PRPS surface shader program linking failed:" << m_program->log();
+        return;
+    }
+
+    CameraUniformBuffer::getInstance().attach(*m_program);
+    m_uniforms.time = m_program->uniformLocation("uTime");
+    m_uniforms.speed = m_program->uniformLocation("uSpeed");
+    m_uniforms.scroll = m_program->uniformLocation("uScroll");
+    m_uniforms.phase = m_program->uniformLocation("uPhase");
+    m_uniforms.range = m_program->uniformLocation("uRange");
+    m_uniforms.height = m_program->uniformLocation("uHeight");
+    m_uniforms.columns = m_program->uniformLocation("uColumns");
+    m_uniforms.head = m_program->uniformLocation("uHead");
+    m_uniforms.slotValid = m_program->uniformLocation("uSlotValid");
+    m_uniforms.slotBirth = m_program->uniformLocation("uSlotBirth");
+
+    // 高度纹理固定使用 0 号纹理单元
+    m_program->bind();
+    m_program->setUniformValue("uHeights", 0);
+    m_program->release();
+}
+
+void PRPSSurfaceRenderer::initialize(int slotCount, int columns) {
+    m_slotCount = std::max(slotCount, 2);
+    m_columns   = std::max(columns, 1);
+
+    initializeShader();
+
+    // 不使用顶点属性，VAO 只记录索引缓冲绑定
+    m_vao.create();
+    m_vao.bind();
+    glGenBuffers(1, &m_indexBuffer);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+    m_vao.release();
+
+    glGenTextures(1, &m_heightTexture);
+    glBindTexture(GL_TEXTURE_2D, m_heightTexture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    allocateGrid();
+}
+
+void PRPSSurfaceRenderer::allocateGrid() {
+    // 相邻两行之间为一条三角带，带与带之间重复首尾索引生成退化三角形，整张网格连成一条带
+    std::vector<GLuint> indices;
+    indices.reserve(static_cast<size_t>(m_slotCount - 1) * (2 * m_columns + 2));
+    for (int row = 0; row + 1 < m_slotCount; ++row) {
+        const auto lower = static_cast<GLuint>(row * m_columns);
+        const auto upper = static_cast<GLuint>((row + 1) * m_columns);
+        if (row > 0) {
+            indices.push_back(lower);
+        }
+        for (int column = 0; column < m_columns; ++column) {
+            indices.push_back(lower + column);
+            indices.push_back(upper + column);
+        }
+        if (row + 2 < m_slotCount) {
+            indices.push_back(upper + m_columns - 1);
+        }
+    }
+    m_indexCount = static_cast<GLsizei>(indices.size());
+
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, m_indexBuffer);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, static_cast<GLsizeiptr>(indices.size() * sizeof(GLuint)), indices.data(),
+                 GL_STATIC_DRAW);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, 0);
+
+    // 所有槽位标记为空，纹理内容无需初始化
+    glBindTexture(GL_TEXTURE_2D, m_heightTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, m_columns, m_slotCount, 0, GL_RED, GL_FLOAT, nullptr);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_staging.resize(m_columns);
+    m_slotValid.assign(m_slotCount, 0);
+    m_slotBirth.assign(m_slotCount, 0.0f);
+}
+
+void PRPSSurfaceRenderer::setColumns(int columns) {
+    columns = std::max(columns, 1);
+    if (columns == m_columns || !m_heightTexture) {
+        return;
+    }
+    m_columns = columns;
+    allocateGrid();
+}
+
+void PRPSSurfaceRenderer::writeRow(int slot, const float* heights, int count, float birth) {
+    if (!m_heightTexture || slot < 0 || slot >= m_slotCount) {
+        return;
+    }
+
+    count = std::clamp(count, 0, m_columns);
+    if (count == 0) {
+        m_slotValid[slot] = 0;
+        return;
+    }
+    std::copy(heights, heights + count, m_staging.begin());
+    std::fill(m_staging.begin() + count, m_staging.end(), -std::numeric_limits<float>::infinity());
+    m_slotValid[slot] = 1;
+    m_slotBirth[slot] = birth;
+
+    glBindTexture(GL_TEXTURE_2D, m_heightTexture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, slot, m_columns, 1, GL_RED, GL_FLOAT, m_staging.data());
+    glBindTexture(GL_TEXTURE_2D, 0);
+}
+
+void PRPSSurfaceRenderer::clear() {
+    std::fill(m_slotValid.begin(), m_slotValid.end(), 0);
+}
+
+void PRPSSurfaceRenderer::setScrollRange(float startZ, float endZ, float fadeDepth) {
+    m_startZ    = startZ;
+    m_endZ      = endZ;
+    m_fadeDepth = fadeDepth;
+}
+
+void PRPSSurfaceRenderer::draw(const QMatrix4x4& projection, const QMatrix4x4& view,
+                               const PRPSRenderer::DrawParams& params, int headSlot) {
+    if (!m_program || !m_heightTexture || m_indexCount == 0) {
+        return;
+    }
+
+    CameraUniformBuffer::getInstance().update(projection, view);
+
+    m_program->bind();
+    m_program->setUniformValue(m_uniforms.time, params.time);
+    m_program->setUniformValue(m_uniforms.speed, params.speed);
+    m_program->setUniformValue(m_uniforms.scroll, QVector3D(m_startZ, m_endZ, m_fadeDepth));
+    m_program->setUniformValue(m_uniforms.phase, QVector2D(params.phaseScale, params.phaseOffset));
+    m_program->setUniformValue(m_uniforms.range, QVector2D(params.amplitudeMin, params.amplitudeMax));
+    m_program->setUniformValue(m_uniforms.height, params.height);
+    m_program->setUniformValue(m_uniforms.columns, m_columns);
+    m_program->setUniformValue(m_uniforms.head, std::clamp(headSlot, 0, m_slotCount - 1));
+    m_program->setUniformValueArray(m_uniforms.slotValid, m_slotValid.data(), m_slotCount);
+    m_program->setUniformValueArray(m_uniforms.slotBirth, m_slotBirth.data(), m_slotCount, 1);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_heightTexture);
+    m_vao.bind();
+    glDrawElements(GL_TRIANGLE_STRIP, m_indexCount, GL_UNSIGNED_INT, nullptr);
+    m_vao.release();
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_program->release();
+}
+
+void PRPSSurfaceRenderer::destroy() {
+    if (m_heightTexture) {
+        glDeleteTextures(1, &m_heightTexture);
+        m_heightTexture = 0;
+    }
+    if (m_indexBuffer) {
+        glDeleteBuffers(1, &m_indexBuffer);
+        m_indexBuffer = 0;
+    }
+    if (m_vao.isCreated()) {
+        m_vao.destroy();
+    }
+    m_program.reset();
+}
+
+} // namespace ProGraphics
@@ -0,0 +1,63 @@
+﻿#define GL_SILENCE_DEPRECATION
+#include "prographics/core/graphics/camera_uniform_buffer.h"
+#include <QOpenGLContext>
+#include <cstring>
+
+namespace ProGraphics {
+  CameraUniformBuffer::~CameraUniformBuffer() { cleanup(); }
+
+  void CameraUniformBuffer::ensureCreated() {
+    if (!m_initialized) {
+      initializeOpenGLFunctions();
+      m_initialized = true;
+    }
+    if (!m_buffer) {
+      glGenBuffers(1, &m_buffer);
+      glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+      glBufferData(GL_UNIFORM_BUFFER, sizeof(Block), nullptr, GL_DYNAMIC_DRAW);
+      glBindBuffer(GL_UNIFORM_BUFFER, 0);
+      m_blockValid = false;
+      m_boundContext = nullptr;
+    }
+  }
+
+  void CameraUniformBuffer::attach(QOpenGLShaderProgram &program) {
+    ensureCreated();
+    const GLuint blockIndex = glGetUniformBlockIndex(program.programId(), BLOCK_NAME);
+    if (blockIndex != GL_INVALID_INDEX) {
+      glUniformBlockBinding(program.programId(), blockIndex, BINDING_POINT);
+    }
+  }
+
+  void CameraUniformBuffer::update(const QMatrix4x4 &projection, const QMatrix4x4 &view) {
+    ensureCreated();
+
+    QOpenGLContext *context = QOpenGLContext::currentContext();
+    if (m_boundContext != context) {
+      glBindBufferBase(GL_UNIFORM_BUFFER, BINDING_POINT, m_buffer);
+      m_boundContext = context;
+    }
+
+    Block block;
+    std::memcpy(block.projection, projection.constData(), sizeof(block.projection));
+    std::memcpy(block.view, view.constData(), sizeof(block.view));
+    if (m_blockValid && std::memcmp(&block, &m_block, sizeof(Block)) == 0) {
+      return;
+    }
+
+    glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(Block), &block);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    m_block = block;
+    m_blockValid = true;
+  }
+
+  void CameraUniformBuffer::cleanup() {
+    if (m_buffer && QOpenGLContext::currentContext()) {
+      glDeleteBuffers(1, &m_buffer);
+    }
+    m_buffer = 0;
+    m_blockValid = false;
+    m_boundContext = nullptr;
+  }
+} // namespace ProGraphics
@@ -0,0 +1,283 @@
+﻿#define GL_SILENCE_DEPRECATION
+#include "prographics/core/graphics/gpu_buffer_allocator.h"
+#include <QOpenGLContext>
+#include <algorithm>
+#include <bit>
+
+namespace ProGraphics {
+  GpuBufferAllocator::~GpuBufferAllocator() { cleanup(); }
+
+  uint8_t GpuBufferAllocator::sizeClassFor(size_t bytes) {
+    const auto sizeClass = static_cast<size_t>(std::bit_width((std::max<size_t>(bytes, 1) - 1) / MIN_BLOCK));
+    return sizeClass < CLASS_COUNT ? static_cast<uint8_t>(sizeClass) : DEDICATED;
+  }
+
+  uint32_t GpuBufferAllocator::createArena(size_t size, bool dedicated) {
+    uint32_t index;
+    if (!m_freeArenaIndices.empty()) {
+      index = m_freeArenaIndices.back();
+      m_freeArenaIndices.pop_back();
+    } else {
+      index = static_cast<uint32_t>(m_arenas.size());
+      m_arenas.emplace_back();
+    }
+
+    // 使用 COPY_WRITE 目标，不影响调用方当前绑定的 GL_ARRAY_BUFFER
+    Arena &arena = m_arenas[index];
+    glGenBuffers(1, &arena.buffer);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, arena.buffer);
+    glBufferData(GL_COPY_WRITE_BUFFER, static_cast<GLsizeiptr>(size), nullptr, GL_STATIC_DRAW);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+    arena.size = size;
+    arena.used = dedicated ? size : 0;
+    arena.dedicated = dedicated;
+    return index;
+  }
+
+  void GpuBufferAllocator::destroyArena(uint32_t index) {
+    Arena &arena = m_arenas[index];
+    if (arena.buffer && QOpenGLContext::currentContext()) {
+      glDeleteBuffers(1, &arena.buffer);
+    }
+    arena = Arena{};
+    m_freeArenaIndices.push_back(index);
+    if (m_currentArena == index) {
+      m_currentArena = UINT32_MAX;
+    }
+  }
+
+  void GpuBufferAllocator::retireTail(uint32_t index) {
+    // 尾部剩余空间按从大到小的级别拆成块放入空闲链表，不浪费
+    Arena &arena = m_arenas[index];
+    while (arena.size - arena.used >= MIN_BLOCK) {
+      const size_t remaining = arena.size - arena.used;
+      auto sizeClass = static_cast<uint8_t>(std::bit_width(remaining / MIN_BLOCK) - 1);
+      sizeClass = std::min<uint8_t>(sizeClass, CLASS_COUNT - 1);
+      m_freeBlocks[sizeClass].push_back({index, arena.used});
+      m_freeBytes += classSize(sizeClass);
+      arena.used += classSize(sizeClass);
+    }
+  }
+
+  GpuBufferAllocator::Block GpuBufferAllocator::carve(uint8_t sizeClass) {
+    const size_t size = classSize(sizeClass);
+    if (m_currentArena == UINT32_MAX || m_arenas[m_currentArena].used + size > m_arenas[m_currentArena].size) {
+      if (m_currentArena != UINT32_MAX) {
+        retireTail(m_currentArena);
+      }
+      m_currentArena = createArena(ARENA_SIZE, false);
+    }
+    Arena &arena = m_arenas[m_currentArena];
+    const Block block{m_currentArena, arena.used};
+    arena.used += size;
+    return block;
+  }
+
+  GpuBufferHandle GpuBufferAllocator::allocate(size_t bytes) {
+    if (!m_initialized) {
+      initializeOpenGLFunctions();
+      m_initialized = true;
+    }
+
+    const uint8_t sizeClass = sizeClassFor(bytes);
+    Block block;
+    if (sizeClass == DEDICATED) {
+      block = {createArena(bytes, true), 0};
+    } else if (!m_freeBlocks[sizeClass].empty()) {
+      block = m_freeBlocks[sizeClass].back();
+      m_freeBlocks[sizeClass].pop_back();
+      m_freeBytes -= classSize(sizeClass);
+    } else {
+      block = carve(sizeClass);
+    }
+
+    uint32_t index;
+    if (!m_freeSlots.empty()) {
+      index = m_freeSlots.back();
+      m_freeSlots.pop_back();
+    } else {
+      index = static_cast<uint32_t>(m_slots.size());
+      m_slots.emplace_back();
+    }
+    Slot &slot = m_slots[index];
+    slot.block = block;
+    slot.size = bytes;
+    slot.sizeClass = sizeClass;
+    slot.live = true;
+    return {index, slot.generation};
+  }
+
+  const GpuBufferAllocator::Slot *GpuBufferAllocator::resolve(GpuBufferHandle handle) const {
+    if (!handle.isValid() || handle.index >= m_slots.size()) {
+      return nullptr;
+    }
+    const Slot &slot = m_slots[handle.index];
+    return slot.live && slot.generation == handle.generation ? &slot : nullptr;
+  }
+
+  void GpuBufferAllocator::release(GpuBufferHandle handle) {
+    if (!resolve(handle)) {
+      return;
+    }
+    Slot &slot = m_slots[handle.index];
+    if (slot.sizeClass == DEDICATED) {
+      destroyArena(slot.block.arena);
+    } else {
+      m_freeBlocks[slot.sizeClass].push_back(slot.block);
+      m_freeBytes += classSize(slot.sizeClass);
+    }
+    slot.live = false;
+    // 代数跳过 0，保证过期句柄永远不会被当作空句柄以外的有效句柄
+    if (++slot.generation == 0) {
+      slot.generation = 1;
+    }
+    m_freeSlots.push_back(handle.index);
+  }
+
+  GpuBufferLocation GpuBufferAllocator::location(GpuBufferHandle handle) const {
+    const Slot *slot = resolve(handle);
+    if (!slot) {
+      return {};
+    }
+    const Arena &arena = m_arenas[slot->block.arena];
+    const size_t capacity = slot->sizeClass == DEDICATED ? arena.size : classSize(slot->sizeClass);
+    return {arena.buffer, slot->block.offset, slot->size, capacity};
+  }
+
+  void GpuBufferAllocator::upload(GpuBufferHandle handle, const void *data, size_t bytes, size_t offset) {
+    const GpuBufferLocation target = location(handle);
+    if (!target.buffer || offset >= target.capacity || bytes == 0) {
+      return;
+    }
+    bytes = std::min(bytes, target.capacity - offset);
+    // 在块容量内写出原申请大小时扩大有效大小，compact() 按有效大小复制
+    Slot &slot = m_slots[handle.index];
+    slot.size = std::max(slot.size, offset + bytes);
+
+    glBindBuffer(GL_COPY_WRITE_BUFFER, target.buffer);
+    glBufferSubData(GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(target.offset + offset),
+                    static_cast<GLsizeiptr>(bytes), data);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+  }
+
+  size_t GpuBufferAllocator::compact() {
+    const bool hasFreeBlocks = std::any_of(m_freeBlocks.begin(), m_freeBlocks.end(),
+                                           [](const std::vector<Block> &blocks) { return !blocks.empty(); });
+    if (!m_initialized || !hasFreeBlocks) {
+      return 0;
+    }
+
+    const size_t reservedBefore = stats().reservedBytes;
+    std::vector<uint32_t> oldArenas;
+    for (uint32_t i = 0; i < m_arenas.size(); ++i) {
+      if (m_arenas[i].buffer && !m_arenas[i].dedicated) {
+        oldArenas.push_back(i);
+      }
+    }
+
+    // 大块在前紧密排列；块仍保持原级别的容量，释放后可直接回到对应的空闲链表
+    std::vector<uint32_t> liveSlots;
+    for (uint32_t i = 0; i < m_slots.size(); ++i) {
+      if (m_slots[i].live && m_slots[i].sizeClass != DEDICATED) {
+        liveSlots.push_back(i);
+      }
+    }
+    std::sort(liveSlots.begin(), liveSlots.end(), [this](uint32_t a, uint32_t b) {
+      return m_slots[a].sizeClass > m_slots[b].sizeClass;
+    });
+
+    for (auto &blocks: m_freeBlocks) {
+      blocks.clear();
+    }
+    m_freeBytes = 0;
+    m_currentArena = UINT32_MAX;
+
+    for (uint32_t index: liveSlots) {
+      Slot &slot = m_slots[index];
+      const size_t size = classSize(slot.sizeClass);
+      if (m_currentArena == UINT32_MAX || m_arenas[m_currentArena].used + size > m_arenas[m_currentArena].size) {
+        if (m_currentArena != UINT32_MAX) {
+          retireTail(m_currentArena);
+        }
+        m_currentArena = createArena(ARENA_SIZE, false);
+      }
+      Arena &target = m_arenas[m_currentArena];
+      glBindBuffer(GL_COPY_READ_BUFFER, m_arenas[slot.block.arena].buffer);
+      glBindBuffer(GL_COPY_WRITE_BUFFER, target.buffer);
+      glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, static_cast<GLintptr>(slot.block.offset),
+                          static_cast<GLintptr>(target.used), static_cast<GLsizeiptr>(slot.size));
+      slot.block = {m_currentArena, target.used};
+      target.used += size;
+    }
+    glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    glBindBuffer(GL_COPY_WRITE_BUFFER, 0);
+
+    for (uint32_t index: oldArenas) {
+      destroyArena(index);
+    }
+    ++m_epoch;
+
+    const size_t reservedAfter = stats().reservedBytes;
+    return reservedBefore > reservedAfter ? reservedBefore - reservedAfter : 0;
+  }
+
+  size_t GpuBufferAllocator::maintain() {
+    if (!m_initialized || m_freeBytes < ARENA_SIZE) {
+      return 0;
+    }
+    // 存活块按级别从大到小排列时可紧密装入，空闲量达到一个 arena 就至少能回收一个 arena
+    size_t sharedBytes = 0;
+    for (const Arena &arena: m_arenas) {
+      if (arena.buffer && !arena.dedicated) {
+        sharedBytes += arena.size;
+      }
+    }
+    return m_freeBytes * 2 >= sharedBytes ? compact() : 0;
+  }
+
+  GpuBufferAllocator::Stats GpuBufferAllocator::stats() const {
+    Stats result;
+    for (const Arena &arena: m_arenas) {
+      if (!arena.buffer) {
+        continue;
+      }
+      ++(arena.dedicated ? result.dedicatedBuffers : result.arenas);
+      result.reservedBytes += arena.size;
+    }
+    for (const Slot &slot: m_slots) {
+      if (slot.live) {
+        ++result.liveAllocations;
+        result.liveBytes += slot.size;
+      }
+    }
+    result.freeBytes = m_freeBytes;
+    return result;
+  }
+
+  void GpuBufferAllocator::cleanup() {
+    for (uint32_t i = 0; i < m_arenas.size(); ++i) {
+      if (m_arenas[i].buffer) {
+        destroyArena(i);
+      }
+    }
+    m_arenas.clear();
+    m_freeArenaIndices.clear();
+    m_currentArena = UINT32_MAX;
+    for (auto &blocks: m_freeBlocks) {
+      blocks.clear();
+    }
+    m_freeBytes = 0;
+    m_freeSlots.clear();
+    for (uint32_t i = 0; i < m_slots.size(); ++i) {
+      Slot &slot = m_slots[i];
+      if (slot.live) {
+        slot.live = false;
+        if (++slot.generation == 0) {
+          slot.generation = 1;
+        }
+      }
+      m_freeSlots.push_back(i);
+    }
+    ++m_epoch;
+  }
+} // namespace ProGraphics
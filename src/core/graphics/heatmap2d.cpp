@@ -0,0 +1,202 @@
+﻿#define GL_SILENCE_DEPRECATION
+#include "prographics/core/graphics/heatmap2d.h"
+#include "prographics/core/graphics/camera_uniform_buffer.h"
+#include "prographics/core/graphics/shader_colormap.h"
+#include <string>
+
+namespace ProGraphics {
+  Heatmap2D::Heatmap2D() {
+    initializeOpenGLFunctions();
+  }
+
+  Heatmap2D::~Heatmap2D() { destroy(); }
+
+  void Heatmap2D::initializeShader() {
+    m_program = std::make_unique<QOpenGLShaderProgram>();
+    m_uniforms = UniformLocations{};
+
+    const char *vertexShaderSource = R"(
+            #version 410 core
+            layout (location = 0) in vec2 aUV;
+
+            layout (std140) uniform CameraBlock {
+                mat4 projection;
+                mat4 view;
+            };
+            uniform vec2 uRectMin;
+            uniform vec2 uRectMax;
+
+            out vec2 vUV;
+
+            void main() {
+                vUV = aUV;
+                vec2 pos = mix(uRectMin, uRectMax, aUV);
+                gl_Position = projection * view * vec4(pos, 0.0, 1.0);
+            }
+        )";
+
+    // 色相与 PRPDChart::calculateColor 一致，亮度随强度略微提高
+    const std::string fragmentShaderSource = std::string(R"(
+            #version 410 core
+            in vec2 vUV;
+            out vec4 FragColor;
+
+            uniform sampler2D uGrid;
+            uniform ivec2 uGridSize; // (cols, rows)
+            uniform float uMaxValue;
+            uniform float uMinValue;
+        )") + INTENSITY_COLORMAP_GLSL + R"(
+            void main() {
+                ivec2 cell = ivec2(vUV.y * float(uGridSize.x), vUV.x * float(uGridSize.y));
+                cell = clamp(cell, ivec2(0), uGridSize - 1);
+                float value = texelFetch(uGrid, cell, 0).r;
+                if (value <= uMinValue || uMaxValue <= 0.0) {
+                    discard;
+                }
+                float intensity = clamp(value / uMaxValue, 0.0, 1.0);
+                vec3 rgb = intensityColor(intensity, 0.8 + intensity * 0.2);
+                FragColor = vec4(rgb, 0.6 + intensity * 0.4);
+            }
+        )";
+
+    if (!m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShaderSource)) {
+      qDebug() << "Heatmap vertex shader compilation failed:" << m_program->log();
+      return;
+    }
+    if (!m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShaderSource.c_str())) {
+      qDebug() << "Heatmap fragment shader compilation failed:" << m_program->log();
+      return;
+    }
+    if (!m_program->link()) {
+      qDebug() << "Heatmap shader program linking failed:" << m_program->log();
+      return;
+    }
+
+    CameraUniformBuffer::getInstance().attach(*m_program);
+    m_uniforms.rectMin = m_program->uniformLocation("uRectMin");
+    m_uniforms.rectMax = m_program->uniformLocation("uRectMax");
+    m_uniforms.gridSize = m_program->uniformLocation("uGridSize");
+    m_uniforms.maxValue = m_program->uniformLocation("uMaxValue");
+    m_uniforms.minValue = m_program->uniformLocation("uMinValue");
+
+    // 网格纹理固定使用 0 号纹理单元
+    m_program->bind();
+    m_program->setUniformValue("uGrid", 0);
+    m_program->release();
+  }
+
+  void Heatmap2D::initialize() {
+    initializeShader();
+
+    // 单位正方形，按三角带顺序
+    const float quad[] = {
+      0.0f, 0.0f,
+      1.0f, 0.0f,
+      0.0f, 1.0f,
+      1.0f, 1.0f
+    };
+
+    m_vao.create();
+    m_vao.bind();
+    m_vbo.create();
+    m_vbo.bind();
+    m_vbo.allocate(quad, sizeof(quad));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(float), nullptr);
+    m_vbo.release();
+    m_vao.release();
+
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    m_textureDirty = true;
+  }
+
+  void Heatmap2D::resize(int rows, int cols) {
+    if (rows == m_rows && cols == m_cols) {
+      return;
+    }
+    m_rows = rows;
+    m_cols = cols;
+    m_textureDirty = true;
+  }
+
+  void Heatmap2D::updateRows(int firstRow, int rowCount, const float *data) {
+    if (!m_texture || rowCount <= 0 || m_rows <= 0 || m_cols <= 0) {
+      return;
+    }
+
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    if (m_textureDirty) {
+      // 宽 = 列数，高 = 行数；每个网格行在纹理中连续存放
+      glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, m_cols, m_rows, 0, GL_RED, GL_FLOAT, nullptr);
+      m_textureDirty = false;
+    }
+    glTexSubImage2D(GL_TEXTURE_2D, 0, 0, firstRow, m_cols, rowCount, GL_RED, GL_FLOAT, data);
+    glBindTexture(GL_TEXTURE_2D, 0);
+  }
+
+  void Heatmap2D::draw(const QMatrix4x4 &projection, const QMatrix4x4 &view, float maxValue, float minValue) {
+    if (!m_program || !m_texture || m_textureDirty) {
+      return;
+    }
+
+    // 热力图画在其他图元之下，绘制期间关闭深度测试并开启混合，结束后恢复调用方的状态
+    const GLboolean depthTest = glIsEnabled(GL_DEPTH_TEST);
+    const GLboolean blend = glIsEnabled(GL_BLEND);
+    GLint blendSrcRgb = GL_ONE, blendDstRgb = GL_ZERO, blendSrcAlpha = GL_ONE, blendDstAlpha = GL_ZERO;
+    glGetIntegerv(GL_BLEND_SRC_RGB, &blendSrcRgb);
+    glGetIntegerv(GL_BLEND_DST_RGB, &blendDstRgb);
+    glGetIntegerv(GL_BLEND_SRC_ALPHA, &blendSrcAlpha);
+    glGetIntegerv(GL_BLEND_DST_ALPHA, &blendDstAlpha);
+
+    glDisable(GL_DEPTH_TEST);
+    glEnable(GL_BLEND);
+    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+
+    CameraUniformBuffer::getInstance().update(projection, view);
+
+    m_program->bind();
+    m_program->setUniformValue(m_uniforms.rectMin, m_rectMin);
+    m_program->setUniformValue(m_uniforms.rectMax, m_rectMax);
+    glUniform2i(m_uniforms.gridSize, m_cols, m_rows);
+    m_program->setUniformValue(m_uniforms.maxValue, maxValue);
+    m_program->setUniformValue(m_uniforms.minValue, minValue);
+
+    glActiveTexture(GL_TEXTURE0);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    m_vao.bind();
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, 4);
+    m_vao.release();
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    m_program->release();
+
+    glBlendFuncSeparate(blendSrcRgb, blendDstRgb, blendSrcAlpha, blendDstAlpha);
+    if (!blend) {
+      glDisable(GL_BLEND);
+    }
+    if (depthTest) {
+      glEnable(GL_DEPTH_TEST);
+    }
+  }
+
+  void Heatmap2D::destroy() {
+    if (m_texture) {
+      glDeleteTextures(1, &m_texture);
+      m_texture = 0;
+    }
+    if (m_vbo.isCreated()) {
+      m_vbo.destroy();
+    }
+    if (m_vao.isCreated()) {
+      m_vao.destroy();
+    }
+    m_program.reset();
+  }
+} // namespace ProGraphics
@@ -1,51 +1,13 @@
 ﻿#define GL_SILENCE_DEPRECATION
 #include "prographics/core/graphics/primitive2d.h"
+#include <cstddef>
+#include <iterator>
 
 namespace ProGraphics {
-  QOpenGLBuffer *VertexBufferPool::acquire() {
-    if (m_availableBuffers.empty()) {
-      // 扩展缓冲池
-      size_t oldSize = m_buffers.size();
-      size_t newSize = oldSize == 0 ? INITIAL_POOL_SIZE : oldSize + GROWTH_FACTOR;
-      m_buffers.reserve(newSize);
-
-      for (size_t i = oldSize; i < newSize; ++i) {
-        m_buffers.emplace_back(QOpenGLBuffer::VertexBuffer);
-        m_buffers.back().create();
-        m_availableBuffers.push(i);
-      }
-    }
-
-    size_t index = m_availableBuffers.front();
-    m_availableBuffers.pop();
-    return &m_buffers[index];
-  }
-
-  void VertexBufferPool::release(QOpenGLBuffer *buffer) {
-    auto it =
-        std::find_if(m_buffers.begin(), m_buffers.end(),
-                     [buffer](const QOpenGLBuffer &b) { return &b == buffer; });
-    if (it != m_buffers.end()) {
-      size_t index = std::distance(m_buffers.begin(), it);
-      m_availableBuffers.push(index);
-    }
-  }
-
-  void VertexBufferPool::cleanup() {
-    for (auto &buffer: m_buffers) {
-      if (buffer.isCreated()) {
-        buffer.destroy();
-      }
-    }
-    m_buffers.clear();
-    std::queue<size_t>().swap(m_availableBuffers);
-  }
-
-  VertexBufferPool::~VertexBufferPool() { cleanup(); }
-
   // 静态成员初始化
   std::unique_ptr<QOpenGLShaderProgram> Primitive2D::s_shaderProgram;
   int Primitive2D::s_shaderUsers = 0;
+  Primitive2D::UniformLocations Primitive2D::s_uniforms;
 
   void Primitive2D::initializeShader() {
     if (!s_shaderProgram) {
@@ -56,11 +18,15 @@ namespace ProGraphics {
            #version 410 core
             layout (location = 0) in vec3 aPos;
             layout (location = 1) in vec4 aColor;
-            layout (location = 2) in mat4 instanceMatrix;  // 实例化矩阵
-            layout (location = 6) in vec4 instanceColor;
-
-            uniform mat4 projection;
-            uniform mat4 view;
+            layout (location = 2) in vec2 instancePosition;  // 紧凑实例：位置、缩放、旋转、颜色
+            layout (location = 3) in vec2 instanceScale;
+            layout (location = 4) in float instanceRotation;
+            layout (location = 5) in vec4 instanceColor;
+
+            layout (std140) uniform CameraBlock {
+                mat4 projection;
+                mat4 view;
+            };
             uniform bool useInstancing;
             uniform float pointSize;
             uniform float uAlphaReplace;
@@ -68,8 +34,15 @@ namespace ProGraphics {
             out vec4 vertexColor;
 
             void main() {
-                mat4 modelMatrix = useInstancing ? instanceMatrix : mat4(1.0);
-                gl_Position = projection * view * modelMatrix * vec4(aPos, 1.0);
+                vec4 localPos = vec4(aPos, 1.0);
+                if (useInstancing) {
+                    // 等价于 translate * rotate * scale
+                    vec2 p = aPos.xy * instanceScale;
+                    float c = cos(instanceRotation);
+                    float s = sin(instanceRotation);
+                    localPos.xy = vec2(c * p.x - s * p.y, s * p.x + c * p.y) + instancePosition;
+                }
+                gl_Position = projection * view * localPos;
                 gl_PointSize = pointSize;
                 vec4 c = useInstancing ? instanceColor : aColor;
                 if (uAlphaReplace >= 0.0) {
@@ -95,6 +68,11 @@ namespace ProGraphics {
       s_shaderProgram->addShaderFromSourceCode(QOpenGLShader::Fragment,
                                                fragmentShaderSource);
       s_shaderProgram->link();
+
+      CameraUniformBuffer::getInstance().attach(*s_shaderProgram);
+      s_uniforms.pointSize = s_shaderProgram->uniformLocation("pointSize");
+      s_uniforms.useInstancing = s_shaderProgram->uniformLocation("useInstancing");
+      s_uniforms.alphaReplace = s_shaderProgram->uniformLocation("uAlphaReplace");
     }
     s_shaderUsers++;
   }
@@ -113,10 +91,6 @@ namespace ProGraphics {
   }
 
   Primitive2D::~Primitive2D() {
-    if (m_managedVBO) {
-      VertexBufferPool::getInstance().release(m_managedVBO);
-      m_managedVBO = nullptr;
-    }
     destroy();
     releaseShader();
   }
@@ -124,15 +98,12 @@ namespace ProGraphics {
   void Primitive2D::draw(const QMatrix4x4 &projection, const QMatrix4x4 &view) {
     if (!m_visible || !s_shaderProgram)
       return;
-    if (m_isDirty) {
-      updateVertexData();
-    }
+    updateVertexData();
+    CameraUniformBuffer::getInstance().update(projection, view);
     s_shaderProgram->bind();
-    s_shaderProgram->setUniformValue("projection", projection);
-    s_shaderProgram->setUniformValue("view", view);
-    s_shaderProgram->setUniformValue("pointSize", m_style.pointSize);
-    s_shaderProgram->setUniformValue("useInstancing", false);
-    s_shaderProgram->setUniformValue("uAlphaReplace", -1.0f);
+    s_shaderProgram->setUniformValue(s_uniforms.pointSize, m_style.pointSize);
+    s_shaderProgram->setUniformValue(s_uniforms.useInstancing, false);
+    s_shaderProgram->setUniformValue(s_uniforms.alphaReplace, -1.0f);
     glEnable(GL_PROGRAM_POINT_SIZE);
     m_vao.bind();
     if (m_useIndices) {
@@ -154,85 +125,90 @@ namespace ProGraphics {
     m_vao.bind();
 
     // 创建实例化缓冲
-    if (!m_instanceVBO.isCreated()) {
-      m_instanceVBO.create();
-    }
-    m_instanceVBO.bind();
-
-    // 设置实例化矩阵属性
-    for (int i = 0; i < 4; ++i) {
-      glEnableVertexAttribArray(2 + i);
-      glVertexAttribPointer(2 + i, 4, GL_FLOAT, GL_FALSE, sizeof(QMatrix4x4) + sizeof(QVector4D),
-                            reinterpret_cast<void *>(sizeof(float) * 4 * i));
-      glVertexAttribDivisor(2 + i, 1);
+    m_instanceBuffer.create();
+    m_instanceBuffer.bind();
+
+    // 设置紧凑实例属性：位置、缩放、旋转为浮点，颜色为归一化的 RGBA8
+    constexpr GLsizei stride = sizeof(Primitive2DInstance);
+    glEnableVertexAttribArray(2);
+    glVertexAttribPointer(2, 2, GL_FLOAT, GL_FALSE, stride,
+                          reinterpret_cast<void *>(offsetof(Primitive2DInstance, position)));
+    glEnableVertexAttribArray(3);
+    glVertexAttribPointer(3, 2, GL_FLOAT, GL_FALSE, stride,
+                          reinterpret_cast<void *>(offsetof(Primitive2DInstance, scale)));
+    glEnableVertexAttribArray(4);
+    glVertexAttribPointer(4, 1, GL_FLOAT, GL_FALSE, stride,
+                          reinterpret_cast<void *>(offsetof(Primitive2DInstance, rotation)));
+    glEnableVertexAttribArray(5);
+    glVertexAttribPointer(5, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride,
+                          reinterpret_cast<void *>(offsetof(Primitive2DInstance, color)));
+    for (int location = 2; location <= 5; ++location) {
+      glVertexAttribDivisor(location, 1);
     }
 
-    glEnableVertexAttribArray(6);
-    glVertexAttribPointer(6, 4, GL_FLOAT, GL_FALSE, sizeof(QMatrix4x4) + sizeof(QVector4D),
-                          reinterpret_cast<void *>(sizeof(QMatrix4x4)));
-    glVertexAttribDivisor(6, 1);
-
-    m_instanceVBO.release();
     m_vao.release();
+    m_instanceBuffer.release();
     m_instancedMode = true;
   }
 
-  void Primitive2D::updateInstanceData(const std::vector<Transform2D> &transforms) {
+  void Primitive2D::updateInstanceData(const Primitive2DInstance *instances, size_t count) {
     if (!m_instancedMode) return;
 
-    // 创建包含矩阵和颜色的数据
-    struct InstanceData {
-      QMatrix4x4 matrix;
-      QVector4D color;
-    };
-
-    std::vector<InstanceData> instanceData;
-    instanceData.reserve(transforms.size());
+    m_instanceBuffer.upload(instances, count * sizeof(Primitive2DInstance));
+  }
 
-    for (const auto &transform: transforms) {
-      InstanceData data;
-      data.matrix = transform.getMatrix();
-      data.color = transform.color;
-      instanceData.push_back(data);
+  void Primitive2D::drawInstanced(const QMatrix4x4 &projection, const QMatrix4x4 &view,
+                                  const std::vector<Transform2D> &transforms,
+                                  float alphaReplace,
+                                  bool uploadInstanceData) {
+    if (uploadInstanceData) {
+      m_instanceStaging.clear();
+      m_instanceStaging.reserve(transforms.size());
+      for (const auto &transform: transforms) {
+        m_instanceStaging.push_back(Primitive2DInstance::fromTransform(transform));
+      }
     }
-
-    m_instanceVBO.bind();
-    m_instanceVBO.allocate(instanceData.data(), instanceData.size() * sizeof(InstanceData));
-    m_instanceVBO.release();
+    drawInstanced(projection, view, m_instanceStaging, alphaReplace, uploadInstanceData);
   }
 
   void Primitive2D::drawInstanced(const QMatrix4x4 &projection, const QMatrix4x4 &view,
-                                  const std::vector<Transform2D> &transforms,
+                                  const std::vector<Primitive2DInstance> &instances,
                                   float alphaReplace,
                                   bool uploadInstanceData) {
-    if (!m_visible || !s_shaderProgram || transforms.empty()) return;
+    if (!m_visible || !s_shaderProgram || instances.empty()) return;
 
+    // 与 draw() 一致：顶点数据变化或共享缓冲整理后重新指向顶点块
+    updateVertexData();
     if (!m_instancedMode) {
       initializeInstanceBuffer();
     }
     if (uploadInstanceData) {
-      updateInstanceData(transforms);
+      updateInstanceData(instances.data(), instances.size());
     }
 
+    CameraUniformBuffer::getInstance().update(projection, view);
     s_shaderProgram->bind();
-    s_shaderProgram->setUniformValue("projection", projection);
-    s_shaderProgram->setUniformValue("view", view);
-    s_shaderProgram->setUniformValue("useInstancing", true);
-    s_shaderProgram->setUniformValue("pointSize", m_style.pointSize);
-    s_shaderProgram->setUniformValue("uAlphaReplace", alphaReplace);
+    s_shaderProgram->setUniformValue(s_uniforms.useInstancing, true);
+    s_shaderProgram->setUniformValue(s_uniforms.pointSize, m_style.pointSize);
+    s_shaderProgram->setUniformValue(s_uniforms.alphaReplace, alphaReplace);
 
     m_vao.bind();
-    glDrawArraysInstanced(getPrimitiveType(), 0, m_vertexCount, transforms.size());
+    glDrawArraysInstanced(getPrimitiveType(), 0, m_vertexCount, static_cast<GLsizei>(instances.size()));
     m_vao.release();
-    s_shaderProgram->setUniformValue("useInstancing", false);
-    s_shaderProgram->setUniformValue("uAlphaReplace", -1.0f);
+    s_shaderProgram->setUniformValue(s_uniforms.useInstancing, false);
+    s_shaderProgram->setUniformValue(s_uniforms.alphaReplace, -1.0f);
 
     s_shaderProgram->release();
   }
 
   void Primitive2D::updateVertexData() {
-    if (!m_isDirty)
+    if (!m_isDirty) {
+      // 共享缓冲区被整理后块的位置会变化，只需重新指向新位置
+      if (m_vertexAllocation.isValid() && m_vertexEpoch != GpuBufferAllocator::getInstance().epoch()) {
+        bindVertexAttributes();
+      }
       return;
+    }
 
     std::vector<float> vertices;
     generateVertices(vertices);
@@ -241,10 +217,12 @@ namespace ProGraphics {
   }
 
   void Primitive2D::destroy() {
-    if (m_managedVBO) {
-      VertexBufferPool::getInstance().release(m_managedVBO);
-      m_managedVBO = nullptr;
+    if (m_vertexAllocation.isValid()) {
+      GpuBufferAllocator::getInstance().release(m_vertexAllocation);
+      m_vertexAllocation = {};
     }
+    m_instanceBuffer.destroy();
+    m_instancedMode = false;
     if (m_vao.isCreated()) {
       m_vao.destroy();
     }
@@ -254,33 +232,45 @@ namespace ProGraphics {
     if (!m_vao.isCreated()) {
       m_vao.create();
     }
-    m_vao.bind();
 
-    // 使用缓冲池获取VBO
-    if (m_managedVBO) {
-      VertexBufferPool::getInstance().release(m_managedVBO);
+    // 顶点数据放在共享缓冲区的一个块中，容量足够时原地覆盖
+    auto &allocator = GpuBufferAllocator::getInstance();
+    const size_t bytes = vertices.size() * sizeof(float);
+    if (!m_vertexAllocation.isValid() || allocator.location(m_vertexAllocation).capacity < bytes) {
+      allocator.release(m_vertexAllocation);
+      m_vertexAllocation = allocator.allocate(bytes);
     }
-    m_managedVBO = VertexBufferPool::getInstance().acquire();
+    allocator.upload(m_vertexAllocation, vertices.data(), bytes);
+    m_vertexStride = stride;
+    bindVertexAttributes();
 
-    m_managedVBO->bind();
-    m_managedVBO->allocate(vertices.data(), vertices.size() * sizeof(float));
+    m_cachedVertices = vertices;
+    m_isDirty = false;
+  }
+
+  void Primitive2D::bindVertexAttributes() {
+    auto &allocator = GpuBufferAllocator::getInstance();
+    const GpuBufferLocation location = allocator.location(m_vertexAllocation);
+    m_vertexEpoch = allocator.epoch();
+    if (!location.buffer) {
+      return;
+    }
+
+    m_vao.bind();
+    glBindBuffer(GL_ARRAY_BUFFER, location.buffer);
 
-    // 设置顶点属性
     // 位置
-    QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
-    f->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride * sizeof(float), 0);
-    f->glEnableVertexAttribArray(0);
+    const GLsizei stride = m_vertexStride * static_cast<GLsizei>(sizeof(float));
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<void *>(location.offset));
+    glEnableVertexAttribArray(0);
 
     // 颜色
-    f->glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride * sizeof(float),
-                             reinterpret_cast<void *>(3 * sizeof(float)));
-    f->glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride,
+                          reinterpret_cast<void *>(location.offset + 3 * sizeof(float)));
+    glEnableVertexAttribArray(1);
 
-    m_managedVBO->release();
+    glBindBuffer(GL_ARRAY_BUFFER, 0);
     m_vao.release();
-
-    m_cachedVertices = vertices;
-    m_isDirty = false;
   }
 
   void Primitive2D::setupIndexBuffer(const std::vector<GLuint> &indices) {
@@ -324,6 +314,9 @@ namespace ProGraphics {
   // 批量渲染实现
   void Primitive2DBatch::begin() {
     m_items.clear();
+    m_staging.clear();
+    m_dirtyBegin = m_dirtyEnd = 0;
+    m_groupsDirty = true;
     // 启用深度测试但禁用深度写入，解决透明度问题
     glEnable(GL_DEPTH_TEST);
     glDepthMask(GL_FALSE);
@@ -333,53 +326,136 @@ namespace ProGraphics {
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
   }
 
-  void Primitive2DBatch::add(const std::vector<float> &vertices, int vertexCount,
-                             GLenum primitiveType) {
-    BatchItem item;
-    item.vertices = vertices;
-    item.vertexCount = vertexCount;
-    item.primitiveType = primitiveType;
-    m_items.push_back(item);
+  size_t Primitive2DBatch::add(const float *vertices, int vertexCount,
+                               GLenum primitiveType) {
+    const size_t count = static_cast<size_t>(std::max(vertexCount, 0));
+    std::copy_n(vertices, count * FLOATS_PER_VERTEX, append(vertexCount, primitiveType));
+    return m_items.size() - 1;
   }
 
-  void Primitive2DBatch::end() {
-    // 计算总顶点数
-    size_t totalVertices = 0;
-    for (const auto &item: m_items) {
-      totalVertices += item.vertices.size();
+  float *Primitive2DBatch::append(int vertexCount, GLenum primitiveType) {
+    const size_t first = m_staging.size() / FLOATS_PER_VERTEX;
+    const size_t count = static_cast<size_t>(std::max(vertexCount, 0));
+    m_staging.resize(m_staging.size() + count * FLOATS_PER_VERTEX);
+    m_items.push_back({static_cast<GLint>(first), static_cast<GLsizei>(count), primitiveType});
+    markDirty(first, count);
+    m_groupsDirty = true;
+    return m_staging.data() + first * FLOATS_PER_VERTEX;
+  }
+
+  size_t Primitive2DBatch::add(const std::vector<float> &vertices, int vertexCount,
+                               GLenum primitiveType) {
+    // 顶点数不超过实际提供的数据，保证后续图元的偏移正确
+    const int available = static_cast<int>(vertices.size() / FLOATS_PER_VERTEX);
+    return add(vertices.data(), std::min(vertexCount, available), primitiveType);
+  }
+
+  void Primitive2DBatch::update(size_t item, const std::vector<float> &vertices) {
+    if (item >= m_items.size()) {
+      return;
     }
+    const BatchItem &target = m_items[item];
+    const size_t count = std::min(static_cast<size_t>(target.vertexCount), vertices.size() / FLOATS_PER_VERTEX);
+    std::copy_n(vertices.begin(), count * FLOATS_PER_VERTEX,
+                m_staging.begin() + static_cast<ptrdiff_t>(target.first) * FLOATS_PER_VERTEX);
+    markDirty(target.first, count);
+  }
 
-    // 合并所有顶点数据
-    std::vector<float> batchedVertices;
-    batchedVertices.reserve(totalVertices);
-    for (const auto &item: m_items) {
-      batchedVertices.insert(batchedVertices.end(), item.vertices.begin(),
-                             item.vertices.end());
+  float *Primitive2DBatch::update(size_t item) {
+    if (item >= m_items.size()) {
+      return nullptr;
+    }
+    const BatchItem &target = m_items[item];
+    markDirty(target.first, target.vertexCount);
+    return m_staging.data() + static_cast<size_t>(target.first) * FLOATS_PER_VERTEX;
+  }
+
+  void Primitive2DBatch::markDirty(size_t firstVertex, size_t vertexCount) {
+    if (vertexCount == 0) {
+      return;
+    }
+    if (m_dirtyBegin == m_dirtyEnd) {
+      m_dirtyBegin = firstVertex;
+      m_dirtyEnd = firstVertex + vertexCount;
+    } else {
+      m_dirtyBegin = std::min(m_dirtyBegin, firstVertex);
+      m_dirtyEnd = std::max(m_dirtyEnd, firstVertex + vertexCount);
+    }
+  }
+
+  void Primitive2DBatch::uploadPending() {
+    if (m_groupsDirty) {
+      rebuildDrawGroups();
+    }
+    if (m_dirtyBegin == m_dirtyEnd) {
+      return;
     }
 
-    // 创建并填充VBO
     if (!m_batchVAO.isCreated()) {
       m_batchVAO.create();
     }
     m_batchVAO.bind();
-
     if (!m_batchVBO.isCreated()) {
       m_batchVBO.create();
+      m_batchVBO.setUsagePattern(QOpenGLBuffer::DynamicDraw);
     }
     m_batchVBO.bind();
-    m_batchVBO.allocate(batchedVertices.data(),
-                        batchedVertices.size() * sizeof(float));
 
-    // 设置顶点属性
-    QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
-    f->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 7 * sizeof(float), 0);
-    f->glEnableVertexAttribArray(0);
-    f->glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, 7 * sizeof(float),
-                             reinterpret_cast<void *>(3 * sizeof(float)));
-    f->glEnableVertexAttribArray(1);
+    const size_t vertexCount = m_staging.size() / FLOATS_PER_VERTEX;
+    constexpr size_t vertexBytes = FLOATS_PER_VERTEX * sizeof(float);
+    if (vertexCount > m_gpuVertexCapacity) {
+      // 按暂存区容量分配，后续增长不必每次重新分配
+      m_gpuVertexCapacity = m_staging.capacity() / FLOATS_PER_VERTEX;
+      m_batchVBO.allocate(static_cast<int>(m_gpuVertexCapacity * vertexBytes));
+      m_batchVBO.write(0, m_staging.data(), static_cast<int>(vertexCount * vertexBytes));
+
+      // 设置顶点属性
+      QOpenGLFunctions *f = QOpenGLContext::currentContext()->functions();
+      f->glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, vertexBytes, 0);
+      f->glEnableVertexAttribArray(0);
+      f->glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, vertexBytes,
+                               reinterpret_cast<void *>(3 * sizeof(float)));
+      f->glEnableVertexAttribArray(1);
+    } else {
+      m_batchVBO.write(static_cast<int>(m_dirtyBegin * vertexBytes),
+                       m_staging.data() + m_dirtyBegin * FLOATS_PER_VERTEX,
+                       static_cast<int>((m_dirtyEnd - m_dirtyBegin) * vertexBytes));
+    }
 
     m_batchVBO.release();
     m_batchVAO.release();
+    m_dirtyBegin = m_dirtyEnd = 0;
+  }
+
+  void Primitive2DBatch::rebuildDrawGroups() {
+    m_drawGroups.clear();
+    for (const auto &item: m_items) {
+      if (item.vertexCount == 0) {
+        continue;
+      }
+      auto group = std::find_if(m_drawGroups.begin(), m_drawGroups.end(), [&item](const DrawGroup &g) {
+        return g.primitiveType == item.primitiveType;
+      });
+      if (group == m_drawGroups.end()) {
+        m_drawGroups.push_back({item.primitiveType, {}, {}});
+        group = m_drawGroups.end() - 1;
+      }
+
+      // 独立图元的相邻区间可以直接拼接；条带和扇形必须保持各自的区间
+      const bool mergeable = item.primitiveType == GL_LINES || item.primitiveType == GL_POINTS ||
+                             item.primitiveType == GL_TRIANGLES;
+      if (mergeable && !group->firsts.empty() && group->firsts.back() + group->counts.back() == item.first) {
+        group->counts.back() += item.vertexCount;
+      } else {
+        group->firsts.push_back(item.first);
+        group->counts.push_back(item.vertexCount);
+      }
+    }
+    m_groupsDirty = false;
+  }
+
+  void Primitive2DBatch::end() {
+    uploadPending();
     // 恢复深度写入
     glDepthMask(GL_TRUE);
   }
@@ -389,24 +465,34 @@ namespace ProGraphics {
     if (m_items.empty())
       return;
 
+    uploadPending();
+    if (m_drawGroups.empty() || !m_batchVAO.isCreated())
+      return;
+
+    if (!m_multiDrawResolved) {
+      // glMultiDrawArrays 不在 QOpenGLExtraFunctions 中，按需从上下文解析
+      if (QOpenGLContext *context = QOpenGLContext::currentContext()) {
+        m_multiDrawArrays = reinterpret_cast<MultiDrawArraysProc>(context->getProcAddress("glMultiDrawArrays"));
+      }
+      m_multiDrawResolved = true;
+    }
+
     // 确保正确的深度测试和混合设置
     glDisable(GL_DEPTH_TEST);
     glDepthMask(GL_FALSE);
     glEnable(GL_BLEND);
     glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+    CameraUniformBuffer::getInstance().update(projection, view);
     Primitive2D::s_shaderProgram->bind();
-    Primitive2D::s_shaderProgram->setUniformValue("projection", projection);
-    Primitive2D::s_shaderProgram->setUniformValue("view", view);
-    Primitive2D::s_shaderProgram->setUniformValue("pointSize", m_style.pointSize);
-    Primitive2D::s_shaderProgram->setUniformValue("useInstancing", false);
-    Primitive2D::s_shaderProgram->setUniformValue("uAlphaReplace", -1.0f);
+    Primitive2D::s_shaderProgram->setUniformValue(Primitive2D::s_uniforms.pointSize, m_style.pointSize);
+    Primitive2D::s_shaderProgram->setUniformValue(Primitive2D::s_uniforms.useInstancing, false);
+    Primitive2D::s_shaderProgram->setUniformValue(Primitive2D::s_uniforms.alphaReplace, -1.0f);
 
     m_batchVAO.bind();
-    size_t offset = 0;
-    for (const auto &item: m_items) {
+    for (const auto &group: m_drawGroups) {
       // 设置线宽（如果是线段）
-      if (item.primitiveType == GL_LINES) {
+      if (group.primitiveType == GL_LINES) {
         if (m_style.lineStyle != Qt::SolidLine) {
           GLint factor = 1;
           GLushort pattern = 0;
@@ -431,11 +517,19 @@ namespace ProGraphics {
         glLineWidth(m_style.lineWidth);
       }
 
-      glDrawArrays(item.primitiveType, offset, item.vertexCount);
-      offset += item.vertexCount;
+      const auto rangeCount = static_cast<GLsizei>(group.firsts.size());
+      if (rangeCount == 1) {
+        glDrawArrays(group.primitiveType, group.firsts[0], group.counts[0]);
+      } else if (m_multiDrawArrays) {
+        m_multiDrawArrays(group.primitiveType, group.firsts.data(), group.counts.data(), rangeCount);
+      } else {
+        for (GLsizei i = 0; i < rangeCount; ++i) {
+          glDrawArrays(group.primitiveType, group.firsts[i], group.counts[i]);
+        }
+      }
 
       // 恢复默认线宽
-      if (item.primitiveType == GL_LINES) {
+      if (group.primitiveType == GL_LINES) {
         glLineWidth(1.0f);
       }
     }
@@ -495,9 +589,7 @@ namespace ProGraphics {
       (void)view;      // 显式标记参数未使用
     if (!m_visible)
       return;
-    if (m_isDirty) {
-      updateVertexData();
-    }
+    updateVertexData();
     // 应用样式
     glLineWidth(m_style.lineWidth);
 
@@ -541,10 +633,25 @@ namespace ProGraphics {
     markDirty();
   }
 
+  void Line2D::writeBatchVertices(float *out) const {
+    const auto write = [this, &out](const QVector3D &pos) {
+      const float vertex[Primitive2DBatch::FLOATS_PER_VERTEX] = {
+        pos.x(), pos.y(), pos.z(), m_color.x(), m_color.y(), m_color.z(), m_color.w()
+      };
+      out = std::copy(std::begin(vertex), std::end(vertex), out);
+    };
+    if (!m_points.empty()) {
+      for (const auto &point: m_points) {
+        write(point);
+      }
+    } else {
+      write(m_start);
+      write(m_end);
+    }
+  }
+
   void Line2D::addToRenderBatch(Primitive2DBatch &batch) {
-    std::vector<float> vertices;
-    generateVertices(vertices);
-    batch.add(vertices, 2, GL_LINES);
+    writeBatchVertices(batch.append(batchVertexCount(), GL_LINES));
   }
 
   // Point2D实现
@@ -564,16 +671,13 @@ namespace ProGraphics {
     if (!m_visible || !s_shaderProgram)
       return;
 
-    if (m_isDirty) {
-      updateVertexData();
-    }
+    updateVertexData();
 
+    CameraUniformBuffer::getInstance().update(projection, view);
     s_shaderProgram->bind();
-    s_shaderProgram->setUniformValue("projection", projection);
-    s_shaderProgram->setUniformValue("view", view);
-    s_shaderProgram->setUniformValue("pointSize", m_size); // 使用特定的点大小
-    s_shaderProgram->setUniformValue("useInstancing", false);
-    s_shaderProgram->setUniformValue("uAlphaReplace", -1.0f);
+    s_shaderProgram->setUniformValue(s_uniforms.pointSize, m_size); // 使用特定的点大小
+    s_shaderProgram->setUniformValue(s_uniforms.useInstancing, false);
+    s_shaderProgram->setUniformValue(s_uniforms.alphaReplace, -1.0f);
     glEnable(GL_PROGRAM_POINT_SIZE);
 
     m_vao.bind();
@@ -1,12 +1,12 @@
-#include "prographics/core/graphics/shape3d.h"
+﻿#include "prographics/core/graphics/shape3d.h"
 
 namespace ProGraphics {
 std::unique_ptr<QOpenGLShaderProgram> Shape3D::s_shaderProgram;
 int Shape3D::s_shaderUsers = 0;
+Shape3D::UniformLocations Shape3D::s_uniforms;
 
 Shape3D::Shape3D()
-    : m_vbo(QOpenGLBuffer::VertexBuffer),
-      m_instanceVBO(QOpenGLBuffer::VertexBuffer), m_vertexCount(0),
+    : m_vbo(QOpenGLBuffer::VertexBuffer), m_vertexCount(0),
       m_visible(true) {
   initializeOpenGLFunctions();
   initializeShader();
@@ -35,9 +35,11 @@ void Shape3D::initializeShader() {
             layout (location = 2) in vec2 aTexCoord;
             layout (location = 3) in mat4 instanceMatrix; // 实例化矩阵
 
+            layout (std140) uniform CameraBlock {
+                mat4 projection;
+                mat4 view;
+            };
             uniform mat4 model;
-            uniform mat4 view;
-            uniform mat4 projection;
             uniform bool useInstancing;
 
             out vec3 FragPos;
@@ -122,6 +124,20 @@ void Shape3D::initializeShader() {
       qDebug() << "Shader program linking failed:" << s_shaderProgram->log();
       return;
     }
+
+    CameraUniformBuffer::getInstance().attach(*s_shaderProgram);
+    s_uniforms.model = s_shaderProgram->uniformLocation("model");
+    s_uniforms.useInstancing = s_shaderProgram->uniformLocation("useInstancing");
+    s_uniforms.ambient = s_shaderProgram->uniformLocation("material_ambient");
+    s_uniforms.diffuse = s_shaderProgram->uniformLocation("material_diffuse");
+    s_uniforms.specular = s_shaderProgram->uniformLocation("material_specular");
+    s_uniforms.shininess = s_shaderProgram->uniformLocation("material_shininess");
+    s_uniforms.opacity = s_shaderProgram->uniformLocation("material_opacity");
+    s_uniforms.wireframe = s_shaderProgram->uniformLocation("material_wireframe");
+    s_uniforms.wireframeColor = s_shaderProgram->uniformLocation("material_wireframe_color");
+    s_uniforms.useTexture = s_shaderProgram->uniformLocation("material_use_texture");
+    s_uniforms.lightPos = s_shaderProgram->uniformLocation("lightPos");
+    s_uniforms.viewPos = s_shaderProgram->uniformLocation("viewPos");
   }
   s_shaderUsers++;
 }
@@ -180,28 +196,7 @@ void Shape3D::draw(const QMatrix4x4 &projection, const QMatrix4x4 &view) {
     return;
 
   s_shaderProgram->bind();
-
-  // 设置变换矩阵
-  s_shaderProgram->setUniformValue("model", m_transform.getMatrix());
-  s_shaderProgram->setUniformValue("view", view);
-  s_shaderProgram->setUniformValue("projection", projection);
-  s_shaderProgram->setUniformValue("useInstancing", false);
-
-  // 设置材质属性
-  s_shaderProgram->setUniformValue("material_ambient", m_material.ambient);
-  s_shaderProgram->setUniformValue("material_diffuse", m_material.diffuse);
-  s_shaderProgram->setUniformValue("material_specular", m_material.specular);
-  s_shaderProgram->setUniformValue("material_shininess", m_material.shininess);
-  s_shaderProgram->setUniformValue("material_opacity", m_material.opacity);
-  s_shaderProgram->setUniformValue("material_wireframe", m_material.wireframe);
-  s_shaderProgram->setUniformValue("material_wireframe_color",
-                                   m_material.wireframeColor);
-  s_shaderProgram->setUniformValue("material_use_texture",
-                                   m_material.useTexture);
-
-  // 设置光照参数（这里使用简单的定点光源）
-  s_shaderProgram->setUniformValue("lightPos", QVector3D(5.0f, 5.0f, 5.0f));
-  s_shaderProgram->setUniformValue("viewPos", QVector3D(0.0f, 0.0f, 5.0f));
+  applyUniforms(projection, view, false);
 
   // 绑定纹理
   if (m_material.useTexture && m_material.texture) {
@@ -224,6 +219,28 @@ void Shape3D::draw(const QMatrix4x4 &projection, const QMatrix4x4 &view) {
   s_shaderProgram->release();
 }
 
+void Shape3D::applyUniforms(const QMatrix4x4 &projection, const QMatrix4x4 &view, bool instancing) {
+  CameraUniformBuffer::getInstance().update(projection, view);
+
+  // 设置变换矩阵
+  s_shaderProgram->setUniformValue(s_uniforms.model, m_transform.getMatrix());
+  s_shaderProgram->setUniformValue(s_uniforms.useInstancing, instancing);
+
+  // 设置材质属性
+  s_shaderProgram->setUniformValue(s_uniforms.ambient, m_material.ambient);
+  s_shaderProgram->setUniformValue(s_uniforms.diffuse, m_material.diffuse);
+  s_shaderProgram->setUniformValue(s_uniforms.specular, m_material.specular);
+  s_shaderProgram->setUniformValue(s_uniforms.shininess, m_material.shininess);
+  s_shaderProgram->setUniformValue(s_uniforms.opacity, m_material.opacity);
+  s_shaderProgram->setUniformValue(s_uniforms.wireframe, m_material.wireframe);
+  s_shaderProgram->setUniformValue(s_uniforms.wireframeColor, m_material.wireframeColor);
+  s_shaderProgram->setUniformValue(s_uniforms.useTexture, m_material.useTexture);
+
+  // 设置光照参数（这里使用简单的定点光源）
+  s_shaderProgram->setUniformValue(s_uniforms.lightPos, QVector3D(5.0f, 5.0f, 5.0f));
+  s_shaderProgram->setUniformValue(s_uniforms.viewPos, QVector3D(0.0f, 0.0f, 5.0f));
+}
+
 void Shape3D::drawInstanced(const QMatrix4x4 &projection,
                             const QMatrix4x4 &view,
                             const std::vector<Transform> &instances) {
@@ -236,34 +253,13 @@ void Shape3D::drawInstanced(const QMatrix4x4 &projection,
   updateInstanceData(instances);
 
   s_shaderProgram->bind();
-
-  s_shaderProgram->setUniformValue("model", m_transform.getMatrix());
-  s_shaderProgram->setUniformValue("view", view);
-  s_shaderProgram->setUniformValue("projection", projection);
-  s_shaderProgram->setUniformValue("useInstancing", true);
-
-  // 设置材质属性
-  s_shaderProgram->setUniformValue("material_ambient", m_material.ambient);
-  s_shaderProgram->setUniformValue("material_diffuse", m_material.diffuse);
-  s_shaderProgram->setUniformValue("material_specular", m_material.specular);
-  s_shaderProgram->setUniformValue("material_shininess", m_material.shininess);
-  s_shaderProgram->setUniformValue("material_opacity", m_material.opacity);
-  s_shaderProgram->setUniformValue("material_wireframe", m_material.wireframe);
-  s_shaderProgram->setUniformValue("material_wireframe_color",
-                                   m_material.wireframeColor);
-  s_shaderProgram->setUniformValue("material_use_texture",
-                                   m_material.useTexture);
-
-  // 设置光照参数（这里使用简单的定点光源）
-  s_shaderProgram->setUniformValue("lightPos", QVector3D(5.0f, 5.0f, 5.0f));
-  s_shaderProgram->setUniformValue("viewPos", QVector3D(0.0f, 0.0f, 5.0f));
+  applyUniforms(projection, view, true);
 
   // 绑定纹理
   if (m_material.useTexture && m_material.texture) {
     m_material.texture->bind();
   }
   m_vao.bind();
-  m_instanceVBO.bind();
   if (m_material.wireframe) {
     glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
   }
@@ -271,29 +267,29 @@ void Shape3D::drawInstanced(const QMatrix4x4 &projection,
   if (m_material.wireframe) {
     glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
   }
-  m_instanceVBO.release();
   m_vao.release();
   s_shaderProgram->release();
 }
 
 void Shape3D::initializeInstanceBuffer() {
   m_vao.bind();
-  m_instanceVBO.create();
-  m_instanceVBO.bind();
+  m_instanceBuffer.create();
 
-  // 为实例矩阵预分配空间
-  m_instanceVBO.allocate(1024 * sizeof(QMatrix4x4)); // 预分配1024个实例的空间
+  // 为实例矩阵预分配空间，之后按需几何增长；矩阵按 16 个 float 紧密排列
+  constexpr GLsizei matrixBytes = 16 * sizeof(float);
+  m_instanceBuffer.reserve(1024 * matrixBytes); // 预分配1024个实例的空间
+  m_instanceBuffer.bind();
 
   // 设置实例化属性
   for (int i = 0; i < 4; i++) {
     glEnableVertexAttribArray(3 + i);
-    glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, sizeof(QMatrix4x4),
-                          reinterpret_cast<void *>(i * sizeof(QVector4D)));
+    glVertexAttribPointer(3 + i, 4, GL_FLOAT, GL_FALSE, matrixBytes,
+                          reinterpret_cast<void *>(i * 4 * sizeof(float)));
     glVertexAttribDivisor(3 + i, 1);
   }
 
-  m_instanceVBO.release();
   m_vao.release();
+  m_instanceBuffer.release();
   m_instancedMode = true;
 }
 
@@ -301,15 +297,15 @@ void Shape3D::updateInstanceData(const std::vector<Transform> &instances) {
   if (!m_instancedMode)
     return;
 
-  std::vector<QMatrix4x4> matrices;
-  matrices.reserve(instances.size());
+  // 直接在复用的暂存区中组装列主序矩阵
+  constexpr size_t floatsPerMatrix = 16;
+  float *matrices = m_instanceBuffer.stage<float>(instances.size() * floatsPerMatrix);
   for (const auto &transform : instances) {
-    matrices.push_back(transform.getMatrix());
+    const QMatrix4x4 matrix = transform.getMatrix();
+    std::copy(matrix.constData(), matrix.constData() + floatsPerMatrix, matrices);
+    matrices += floatsPerMatrix;
   }
-
-  m_instanceVBO.bind();
-  m_instanceVBO.allocate(matrices.data(), static_cast<int>(matrices.size() * sizeof(QMatrix4x4)));
-  m_instanceVBO.release();
+  m_instanceBuffer.uploadStaged(instances.size() * floatsPerMatrix * sizeof(float));
 }
 
 void Shape3D::setLODLevels(const std::vector<int> &segmentCounts) {
@@ -347,6 +343,8 @@ void Shape3D::destroy() {
   if (m_vbo.isCreated()) {
     m_vbo.destroy();
   }
+  m_instanceBuffer.destroy();
+  m_instancedMode = false;
   if (m_vao.isCreated()) {
     m_vao.destroy();
   }
@@ -0,0 +1,82 @@
+﻿#define GL_SILENCE_DEPRECATION
+#include "prographics/core/graphics/streaming_buffer.h"
+#include <QOpenGLContext>
+#include <algorithm>
+
+namespace ProGraphics {
+  namespace {
+    // 只在 GUI 线程（持有 GL 上下文的线程）访问
+    StreamingBuffer::FrameStats *s_activeStats = nullptr;
+  } // namespace
+
+  StreamingBuffer::FrameStatsScope::FrameStatsScope(FrameStats *stats) : m_previous(s_activeStats) {
+    s_activeStats = stats;
+  }
+
+  StreamingBuffer::FrameStatsScope::~FrameStatsScope() { s_activeStats = m_previous; }
+
+  StreamingBuffer::StreamingBuffer(GLenum target, GLenum usage) : m_target(target), m_usage(usage) {}
+
+  StreamingBuffer::~StreamingBuffer() { destroy(); }
+
+  void StreamingBuffer::create() {
+    if (m_buffer) {
+      return;
+    }
+    initializeOpenGLFunctions();
+    glGenBuffers(1, &m_buffer);
+    m_capacity = 0;
+  }
+
+  void StreamingBuffer::bind() { glBindBuffer(m_target, m_buffer); }
+
+  void StreamingBuffer::release() { glBindBuffer(m_target, 0); }
+
+  void StreamingBuffer::reserve(size_t bytes) {
+    if (!m_buffer || bytes <= m_capacity) {
+      return;
+    }
+    size_t capacity = std::max(m_capacity, MIN_CAPACITY);
+    while (capacity < bytes) {
+      capacity *= 2;
+    }
+    glBindBuffer(m_target, m_buffer);
+    glBufferData(m_target, static_cast<GLsizeiptr>(capacity), nullptr, m_usage);
+    m_capacity = capacity;
+    if (s_activeStats) {
+      ++s_activeStats->reallocations;
+    }
+  }
+
+  void StreamingBuffer::upload(const void *data, size_t bytes) {
+    if (!m_buffer || bytes == 0) {
+      return;
+    }
+    if (bytes > m_capacity) {
+      reserve(bytes);
+    } else {
+      // 孤立旧存储：GPU 仍在读取的旧内容由驱动保留，本次写入无需同步等待
+      glBindBuffer(m_target, m_buffer);
+      glBufferData(m_target, static_cast<GLsizeiptr>(m_capacity), nullptr, m_usage);
+    }
+    glBufferSubData(m_target, 0, static_cast<GLsizeiptr>(bytes), data);
+    glBindBuffer(m_target, 0);
+
+    if (s_activeStats) {
+      s_activeStats->bytesUploaded += bytes;
+      ++s_activeStats->uploads;
+    }
+  }
+
+  void StreamingBuffer::uploadStaged(size_t bytes) {
+    upload(m_staging.data(), std::min(bytes, m_staging.size()));
+  }
+
+  void StreamingBuffer::destroy() {
+    if (m_buffer && QOpenGLContext::currentContext()) {
+      glDeleteBuffers(1, &m_buffer);
+    }
+    m_buffer = 0;
+    m_capacity = 0;
+  }
+} // namespace ProGraphics
@@ -0,0 +1,85 @@
+﻿#include "prographics/utils/cycle_codec.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+
+namespace ProGraphics {
+namespace {
+constexpr float kMuLaw = 255.0f;
+
+/// LogUInt8 码值到归一化距离（距周期峰值）的查找表
+const std::array<float, 256> &muLawDecodeTable() {
+  static const std::array<float, 256> table = [] {
+    std::array<float, 256> t{};
+    for (int q = 0; q < 256; ++q) {
+      t[q] = (std::pow(1.0f + kMuLaw, q / 255.0f) - 1.0f) / kMuLaw;
+    }
+    return t;
+  }();
+  return table;
+}
+
+// 只用有限值确定周期范围，没有有限值时范围为 [0, 0]
+void finiteRange(const float *in, size_t count, float &lo, float &hi) {
+  lo = std::numeric_limits<float>::max();
+  hi = std::numeric_limits<float>::lowest();
+  for (size_t i = 0; i < count; ++i) {
+    if (std::isfinite(in[i])) {
+      lo = std::min(lo, in[i]);
+      hi = std::max(hi, in[i]);
+    }
+  }
+  if (lo > hi) {
+    lo = hi = 0.0f;
+  }
+}
+} // namespace
+
+CycleCodecParams encodeCycleInt16(const float *in, size_t count, uint16_t *out) {
+  float lo, hi;
+  finiteRange(in, count, lo, hi);
+  const float range = hi - lo;
+  const float inv = range > 0.0f ? 65535.0f / range : 0.0f;
+  for (size_t i = 0; i < count; ++i) {
+    // 非有限值在进入乘法之前处理：range 为 0 时 inf * 0 会得到 NaN
+    if (!std::isfinite(in[i])) {
+      out[i] = in[i] == std::numeric_limits<float>::infinity() ? 65535 : 0;
+      continue;
+    }
+    const float t = std::clamp((in[i] - lo) * inv, 0.0f, 65535.0f);
+    out[i] = static_cast<uint16_t>(t + 0.5f);
+  }
+  return {lo, range / 65535.0f};
+}
+
+void decodeCycleInt16(const uint16_t *in, size_t count, CycleCodecParams params, float *out) {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = params.offset + static_cast<float>(in[i]) * params.scale;
+  }
+}
+
+CycleCodecParams encodeCycleLogUInt8(const float *in, size_t count, uint8_t *out) {
+  float lo, hi;
+  finiteRange(in, count, lo, hi);
+  const float range = hi - lo;
+  const float inv = range > 0.0f ? 1.0f / range : 0.0f;
+  const float logNorm = 255.0f / std::log1p(kMuLaw);
+  for (size_t i = 0; i < count; ++i) {
+    if (!std::isfinite(in[i])) {
+      out[i] = in[i] == std::numeric_limits<float>::infinity() ? 0 : 255;
+      continue;
+    }
+    const float u = std::clamp((hi - in[i]) * inv, 0.0f, 1.0f);
+    out[i] = static_cast<uint8_t>(std::log1p(kMuLaw * u) * logNorm + 0.5f);
+  }
+  return {hi, range};
+}
+
+void decodeCycleLogUInt8(const uint8_t *in, size_t count, CycleCodecParams params, float *out) {
+  const auto &table = muLawDecodeTable();
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = params.offset - table[in[i]] * params.scale;
+  }
+}
+} // namespace ProGraphics
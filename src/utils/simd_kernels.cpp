@@ -0,0 +1,466 @@
+﻿#include "prographics/utils/simd_kernels.h"
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64) || defined(__i386__) || defined(_M_IX86)
+#define PROGRAPHICS_SIMD_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define PROGRAPHICS_TARGET_AVX2
+#else
+#define PROGRAPHICS_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace ProGraphics {
+namespace {
+using BinKernel = void (*)(const float *, uint16_t *, size_t, float, float, int);
+using AccumulateKernel = void (*)(float *, const float *, size_t);
+using CountKernel = void (*)(float *, const float *, size_t, float);
+using GateKernel = void (*)(const float *, const float *, float, float, float *, size_t);
+using QuantileKernel = void (*)(float *, const float *, size_t, float, float);
+using DecimateKernel = void (*)(const float *, size_t, size_t, float *, float *, uint32_t *);
+
+constexpr float kNegInf = -std::numeric_limits<float>::infinity();
+constexpr float kPosInf = std::numeric_limits<float>::infinity();
+
+// 一个桶的归约结果：最小值、最大值与最大值首次出现的位置
+struct BucketStats {
+  float min;
+  float max;
+  uint32_t argMax;
+};
+
+// 从 stats 开始继续扫描 [begin, end)，保持“同值取最先出现”的语义
+inline BucketStats reduceBucketScalar(const float *in, size_t begin, size_t end, BucketStats stats) {
+  for (size_t i = begin; i < end; ++i) {
+    if (in[i] > stats.max) {
+      stats.max = in[i];
+      stats.argMax = static_cast<uint32_t>(i);
+    }
+    if (in[i] < stats.min) {
+      stats.min = in[i];
+    }
+  }
+  return stats;
+}
+
+// 按桶切分后逐桶调用 Reduce，编译期绑定以便内联
+template<BucketStats (*Reduce)(const float *, size_t, size_t, BucketStats)>
+inline void decimateWith(const float *in, size_t count, size_t buckets, float *outMin, float *outMax,
+                         uint32_t *outArgMax) {
+  size_t begin = 0;
+  for (size_t b = 0; b < buckets; ++b) {
+    const size_t end = (b + 1) * count / buckets;
+    const BucketStats stats = Reduce(in, begin, end, {kPosInf, kNegInf, static_cast<uint32_t>(begin)});
+    if (outMin != nullptr) {
+      outMin[b] = stats.min;
+    }
+    outMax[b] = stats.max;
+    if (outArgMax != nullptr) {
+      outArgMax[b] = stats.argMax;
+    }
+    begin = end;
+  }
+}
+
+void decimateScalar(const float *in, size_t count, size_t buckets, float *outMin, float *outMax,
+                    uint32_t *outArgMax) {
+  decimateWith<reduceBucketScalar>(in, count, buckets, outMin, outMax, outArgMax);
+}
+
+void binAmplitudesScalar(const float *in, uint16_t *out, size_t count, float min, float invRange, int bins) {
+  for (size_t i = 0; i < count; ++i) {
+    out[i] = binAmplitude(in[i], min, invRange, bins);
+  }
+}
+
+void accumulateMaxScalar(float *acc, const float *in, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    acc[i] = in[i] > acc[i] ? in[i] : acc[i];
+  }
+}
+
+void accumulateSumScalar(float *acc, const float *in, size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    acc[i] += in[i];
+  }
+}
+
+void accumulateCountScalar(float *acc, const float *in, size_t count, float threshold) {
+  for (size_t i = 0; i < count; ++i) {
+    acc[i] += in[i] > threshold ? 1.0f : 0.0f;
+  }
+}
+
+void gateSamplesScalar(const float *in, const float *floor, float margin, float threshold, float *out,
+                       size_t count) {
+  for (size_t i = 0; i < count; ++i) {
+    const bool pass = in[i] >= threshold && (floor == nullptr || in[i] > floor[i] + margin);
+    out[i] = pass ? in[i] : kNegInf;
+  }
+}
+
+void trackQuantileScalar(float *estimate, const float *in, size_t count, float quantile, float step) {
+  const float up = step * quantile;
+  const float down = step * (1.0f - quantile);
+  for (size_t i = 0; i < count; ++i) {
+    estimate[i] += (in[i] > estimate[i] ? up : 0.0f) - (in[i] < estimate[i] ? down : 0.0f);
+  }
+}
+
+#ifdef PROGRAPHICS_SIMD_X86
+void binAmplitudesSse2(const float *in, uint16_t *out, size_t count, float min, float invRange, int bins) {
+  const __m128 vMin = _mm_set1_ps(min);
+  const __m128 vScale = _mm_set1_ps(invRange);
+  const __m128 vZero = _mm_setzero_ps();
+  const __m128 vHi = _mm_set1_ps(0.9999f);
+  const __m128 vBins = _mm_set1_ps(static_cast<float>(bins));
+
+  auto binFour = [&](const float *src) {
+    __m128 t = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(src), vMin), vScale);
+    t = _mm_min_ps(_mm_max_ps(t, vZero), vHi); // max(NaN, 0) 返回第二个操作数 0
+    return _mm_cvttps_epi32(_mm_mul_ps(t, vBins));
+  };
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m128i packed = _mm_packs_epi32(binFour(in + i), binFour(in + i + 4));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), packed);
+  }
+  binAmplitudesScalar(in + i, out + i, count - i, min, invRange, bins);
+}
+
+PROGRAPHICS_TARGET_AVX2
+void binAmplitudesAvx2(const float *in, uint16_t *out, size_t count, float min, float invRange, int bins) {
+  const __m256 vMin = _mm256_set1_ps(min);
+  const __m256 vScale = _mm256_set1_ps(invRange);
+  const __m256 vZero = _mm256_setzero_ps();
+  const __m256 vHi = _mm256_set1_ps(0.9999f);
+  const __m256 vBins = _mm256_set1_ps(static_cast<float>(bins));
+
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    __m256 t = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(in + i), vMin), vScale);
+    t = _mm256_min_ps(_mm256_max_ps(t, vZero), vHi);
+    const __m256i idx = _mm256_cvttps_epi32(_mm256_mul_ps(t, vBins));
+    const __m128i packed = _mm_packs_epi32(_mm256_castsi256_si128(idx), _mm256_extracti128_si256(idx, 1));
+    _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), packed);
+  }
+  binAmplitudesScalar(in + i, out + i, count - i, min, invRange, bins);
+}
+
+// max(in, acc)：任一操作数为 NaN 时返回第二个操作数 acc，与标量实现一致
+void accumulateMaxSse2(float *acc, const float *in, size_t count) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_ps(acc + i, _mm_max_ps(_mm_loadu_ps(in + i), _mm_loadu_ps(acc + i)));
+  }
+  accumulateMaxScalar(acc + i, in + i, count - i);
+}
+
+void accumulateSumSse2(float *acc, const float *in, size_t count) {
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), _mm_loadu_ps(in + i)));
+  }
+  accumulateSumScalar(acc + i, in + i, count - i);
+}
+
+void accumulateCountSse2(float *acc, const float *in, size_t count, float threshold) {
+  const __m128 vThreshold = _mm_set1_ps(threshold);
+  const __m128 vOne = _mm_set1_ps(1.0f);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128 hit = _mm_and_ps(_mm_cmpgt_ps(_mm_loadu_ps(in + i), vThreshold), vOne);
+    _mm_storeu_ps(acc + i, _mm_add_ps(_mm_loadu_ps(acc + i), hit));
+  }
+  accumulateCountScalar(acc + i, in + i, count - i, threshold);
+}
+
+void gateSamplesSse2(const float *in, const float *floor, float margin, float threshold, float *out,
+                     size_t count) {
+  const __m128 vThreshold = _mm_set1_ps(threshold);
+  const __m128 vMargin = _mm_set1_ps(margin);
+  const __m128 vNegInf = _mm_set1_ps(kNegInf);
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128 x = _mm_loadu_ps(in + i);
+    __m128 pass = _mm_cmpge_ps(x, vThreshold);
+    if (floor != nullptr) {
+      pass = _mm_and_ps(pass, _mm_cmpgt_ps(x, _mm_add_ps(_mm_loadu_ps(floor + i), vMargin)));
+    }
+    _mm_storeu_ps(out + i, _mm_or_ps(_mm_and_ps(pass, x), _mm_andnot_ps(pass, vNegInf)));
+  }
+  gateSamplesScalar(in + i, floor ? floor + i : nullptr, margin, threshold, out + i, count - i);
+}
+
+void trackQuantileSse2(float *estimate, const float *in, size_t count, float quantile, float step) {
+  const __m128 vUp = _mm_set1_ps(step * quantile);
+  const __m128 vDown = _mm_set1_ps(step * (1.0f - quantile));
+  size_t i = 0;
+  for (; i + 4 <= count; i += 4) {
+    const __m128 x = _mm_loadu_ps(in + i);
+    const __m128 q = _mm_loadu_ps(estimate + i);
+    const __m128 up = _mm_and_ps(_mm_cmpgt_ps(x, q), vUp);
+    const __m128 down = _mm_and_ps(_mm_cmplt_ps(x, q), vDown);
+    _mm_storeu_ps(estimate + i, _mm_add_ps(q, _mm_sub_ps(up, down)));
+  }
+  trackQuantileScalar(estimate + i, in + i, count - i, quantile, step);
+}
+
+// 窄桶的通道间归约开销超过向量化收益，直接走标量路径。
+// 每条通道各自记录其最大值首次出现的位置，最后在通道间取最大值、同值取最小下标，
+// 结果与从前往后的标量扫描一致
+inline BucketStats reduceBucketSse2(const float *in, size_t begin, size_t end, BucketStats stats) {
+  if (end - begin < 8) {
+    return reduceBucketScalar(in, begin, end, stats);
+  }
+
+  __m128 vMin = _mm_set1_ps(kPosInf);
+  __m128 vMax = _mm_set1_ps(kNegInf);
+  __m128i vArg = _mm_set1_epi32(static_cast<int>(begin));
+  __m128i vIdx = _mm_add_epi32(_mm_set1_epi32(static_cast<int>(begin)), _mm_setr_epi32(0, 1, 2, 3));
+  const __m128i vStep = _mm_set1_epi32(4);
+
+  size_t i = begin;
+  for (; i + 4 <= end; i += 4) {
+    const __m128 x = _mm_loadu_ps(in + i);
+    const __m128 greater = _mm_cmpgt_ps(x, vMax);
+    const __m128 less = _mm_cmplt_ps(x, vMin);
+    vMax = _mm_or_ps(_mm_and_ps(greater, x), _mm_andnot_ps(greater, vMax));
+    vMin = _mm_or_ps(_mm_and_ps(less, x), _mm_andnot_ps(less, vMin));
+    const __m128i g = _mm_castps_si128(greater);
+    vArg = _mm_or_si128(_mm_and_si128(g, vIdx), _mm_andnot_si128(g, vArg));
+    vIdx = _mm_add_epi32(vIdx, vStep);
+  }
+
+  alignas(16) float lanesMin[4];
+  alignas(16) float lanesMax[4];
+  alignas(16) uint32_t lanesArg[4];
+  _mm_store_ps(lanesMin, vMin);
+  _mm_store_ps(lanesMax, vMax);
+  _mm_store_si128(reinterpret_cast<__m128i *>(lanesArg), vArg);
+  for (int lane = 0; lane < 4; ++lane) {
+    if (lanesMax[lane] > stats.max ||
+        (lanesMax[lane] == stats.max && lanesMax[lane] != kNegInf && lanesArg[lane] < stats.argMax)) {
+      stats.max = lanesMax[lane];
+      stats.argMax = lanesArg[lane];
+    }
+    stats.min = lanesMin[lane] < stats.min ? lanesMin[lane] : stats.min;
+  }
+  return reduceBucketScalar(in, i, end, stats);
+}
+
+PROGRAPHICS_TARGET_AVX2
+inline BucketStats reduceBucketAvx2(const float *in, size_t begin, size_t end, BucketStats stats) {
+  if (end - begin < 16) {
+    return reduceBucketScalar(in, begin, end, stats);
+  }
+
+  __m256 vMin = _mm256_set1_ps(kPosInf);
+  __m256 vMax = _mm256_set1_ps(kNegInf);
+  __m256i vArg = _mm256_set1_epi32(static_cast<int>(begin));
+  __m256i vIdx = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(begin)), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+  const __m256i vStep = _mm256_set1_epi32(8);
+
+  size_t i = begin;
+  for (; i + 8 <= end; i += 8) {
+    const __m256 x = _mm256_loadu_ps(in + i);
+    const __m256 greater = _mm256_cmp_ps(x, vMax, _CMP_GT_OQ);
+    const __m256 less = _mm256_cmp_ps(x, vMin, _CMP_LT_OQ);
+    vMax = _mm256_blendv_ps(vMax, x, greater);
+    vMin = _mm256_blendv_ps(vMin, x, less);
+    vArg = _mm256_blendv_epi8(vArg, vIdx, _mm256_castps_si256(greater));
+    vIdx = _mm256_add_epi32(vIdx, vStep);
+  }
+
+  alignas(32) float lanesMin[8];
+  alignas(32) float lanesMax[8];
+  alignas(32) uint32_t lanesArg[8];
+  _mm256_store_ps(lanesMin, vMin);
+  _mm256_store_ps(lanesMax, vMax);
+  _mm256_store_si256(reinterpret_cast<__m256i *>(lanesArg), vArg);
+  for (int lane = 0; lane < 8; ++lane) {
+    if (lanesMax[lane] > stats.max ||
+        (lanesMax[lane] == stats.max && lanesMax[lane] != kNegInf && lanesArg[lane] < stats.argMax)) {
+      stats.max = lanesMax[lane];
+      stats.argMax = lanesArg[lane];
+    }
+    stats.min = lanesMin[lane] < stats.min ? lanesMin[lane] : stats.min;
+  }
+  return reduceBucketScalar(in, i, end, stats);
+}
+
+void decimateSse2(const float *in, size_t count, size_t buckets, float *outMin, float *outMax,
+                  uint32_t *outArgMax) {
+  decimateWith<reduceBucketSse2>(in, count, buckets, outMin, outMax, outArgMax);
+}
+
+PROGRAPHICS_TARGET_AVX2
+void decimateAvx2(const float *in, size_t count, size_t buckets, float *outMin, float *outMax,
+                  uint32_t *outArgMax) {
+  decimateWith<reduceBucketAvx2>(in, count, buckets, outMin, outMax, outArgMax);
+}
+
+PROGRAPHICS_TARGET_AVX2
+void accumulateMaxAvx2(float *acc, const float *in, size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(acc + i, _mm256_max_ps(_mm256_loadu_ps(in + i), _mm256_loadu_ps(acc + i)));
+  }
+  accumulateMaxScalar(acc + i, in + i, count - i);
+}
+
+PROGRAPHICS_TARGET_AVX2
+void accumulateSumAvx2(float *acc, const float *in, size_t count) {
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), _mm256_loadu_ps(in + i)));
+  }
+  accumulateSumScalar(acc + i, in + i, count - i);
+}
+
+PROGRAPHICS_TARGET_AVX2
+void accumulateCountAvx2(float *acc, const float *in, size_t count, float threshold) {
+  const __m256 vThreshold = _mm256_set1_ps(threshold);
+  const __m256 vOne = _mm256_set1_ps(1.0f);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256 hit = _mm256_and_ps(_mm256_cmp_ps(_mm256_loadu_ps(in + i), vThreshold, _CMP_GT_OQ), vOne);
+    _mm256_storeu_ps(acc + i, _mm256_add_ps(_mm256_loadu_ps(acc + i), hit));
+  }
+  accumulateCountScalar(acc + i, in + i, count - i, threshold);
+}
+
+PROGRAPHICS_TARGET_AVX2
+void gateSamplesAvx2(const float *in, const float *floor, float margin, float threshold, float *out,
+                     size_t count) {
+  const __m256 vThreshold = _mm256_set1_ps(threshold);
+  const __m256 vMargin = _mm256_set1_ps(margin);
+  const __m256 vNegInf = _mm256_set1_ps(kNegInf);
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256 x = _mm256_loadu_ps(in + i);
+    __m256 pass = _mm256_cmp_ps(x, vThreshold, _CMP_GE_OQ);
+    if (floor != nullptr) {
+      const __m256 gate = _mm256_add_ps(_mm256_loadu_ps(floor + i), vMargin);
+      pass = _mm256_and_ps(pass, _mm256_cmp_ps(x, gate, _CMP_GT_OQ));
+    }
+    _mm256_storeu_ps(out + i, _mm256_blendv_ps(vNegInf, x, pass));
+  }
+  gateSamplesScalar(in + i, floor ? floor + i : nullptr, margin, threshold, out + i, count - i);
+}
+
+PROGRAPHICS_TARGET_AVX2
+void trackQuantileAvx2(float *estimate, const float *in, size_t count, float quantile, float step) {
+  const __m256 vUp = _mm256_set1_ps(step * quantile);
+  const __m256 vDown = _mm256_set1_ps(step * (1.0f - quantile));
+  size_t i = 0;
+  for (; i + 8 <= count; i += 8) {
+    const __m256 x = _mm256_loadu_ps(in + i);
+    const __m256 q = _mm256_loadu_ps(estimate + i);
+    const __m256 up = _mm256_and_ps(_mm256_cmp_ps(x, q, _CMP_GT_OQ), vUp);
+    const __m256 down = _mm256_and_ps(_mm256_cmp_ps(x, q, _CMP_LT_OQ), vDown);
+    _mm256_storeu_ps(estimate + i, _mm256_add_ps(q, _mm256_sub_ps(up, down)));
+  }
+  trackQuantileScalar(estimate + i, in + i, count - i, quantile, step);
+}
+
+bool cpuSupportsAvx2() {
+#if defined(_MSC_VER) && !defined(__clang__)
+  int info[4] = {};
+  __cpuid(info, 1);
+  const bool osxsave = (info[2] & (1 << 27)) != 0;
+  const bool avx = (info[2] & (1 << 28)) != 0;
+  if (!osxsave || !avx || (_xgetbv(0) & 0x6) != 0x6) {
+    return false;
+  }
+  __cpuidex(info, 7, 0);
+  return (info[1] & (1 << 5)) != 0;
+#else
+  return __builtin_cpu_supports("avx2");
+#endif
+}
+#endif
+
+struct KernelTable {
+  BinKernel bin = binAmplitudesScalar;
+  AccumulateKernel max = accumulateMaxScalar;
+  AccumulateKernel sum = accumulateSumScalar;
+  CountKernel countAbove = accumulateCountScalar;
+  GateKernel gate = gateSamplesScalar;
+  QuantileKernel quantile = trackQuantileScalar;
+  DecimateKernel decimate = decimateScalar;
+  const char *isa = "scalar";
+
+  KernelTable() {
+#ifdef PROGRAPHICS_SIMD_X86
+    if (cpuSupportsAvx2()) {
+      bin = binAmplitudesAvx2;
+      max = accumulateMaxAvx2;
+      sum = accumulateSumAvx2;
+      countAbove = accumulateCountAvx2;
+      gate = gateSamplesAvx2;
+      quantile = trackQuantileAvx2;
+      decimate = decimateAvx2;
+      isa = "avx2";
+    } else {
+      bin = binAmplitudesSse2;
+      max = accumulateMaxSse2;
+      sum = accumulateSumSse2;
+      countAbove = accumulateCountSse2;
+      gate = gateSamplesSse2;
+      quantile = trackQuantileSse2;
+      decimate = decimateSse2;
+      isa = "sse2";
+    }
+#endif
+  }
+};
+
+const KernelTable &kernels() {
+  static const KernelTable table;
+  return table;
+}
+} // namespace
+
+void binAmplitudes(const float *in, uint16_t *out, size_t count, float min, float max, int bins) {
+  const float range = max - min;
+  if (range < 1e-6f) {
+    for (size_t i = 0; i < count; ++i) {
+      out[i] = static_cast<uint16_t>(in[i] <= min ? 0 : (in[i] >= max ? bins - 1 : bins / 2));
+    }
+    return;
+  }
+  kernels().bin(in, out, count, min, 1.0f / range, bins);
+}
+
+void accumulateMax(float *acc, const float *in, size_t count) { kernels().max(acc, in, count); }
+
+void accumulateSum(float *acc, const float *in, size_t count) { kernels().sum(acc, in, count); }
+
+void accumulateCount(float *acc, const float *in, size_t count, float threshold) {
+  kernels().countAbove(acc, in, count, threshold);
+}
+
+void decimateMinMax(const float *in, size_t count, size_t buckets, float *outMin, float *outMax,
+                    uint32_t *outArgMax) {
+  kernels().decimate(in, count, buckets, outMin, outMax, outArgMax);
+}
+
+void decimateMinMaxScalar(const float *in, size_t count, size_t buckets, float *outMin, float *outMax,
+                          uint32_t *outArgMax) {
+  decimateScalar(in, count, buckets, outMin, outMax, outArgMax);
+}
+
+void gateSamples(const float *in, const float *floor, float margin, float threshold, float *out, size_t count) {
+  kernels().gate(in, floor, margin, threshold, out, count);
+}
+
+void trackQuantile(float *estimate, const float *in, size_t count, float quantile, float step) {
+  kernels().quantile(estimate, in, count, quantile, step);
+}
+
+const char *simdKernelIsa() { return kernels().isa; }
+} // namespace ProGraphics
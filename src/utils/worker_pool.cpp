@@ -0,0 +1,89 @@
+﻿#include "prographics/utils/worker_pool.h"
+#include <algorithm>
+
+namespace ProGraphics {
+  WorkerPool &WorkerPool::instance() {
+    // 有意不析构：工作线程阻塞在条件变量上随进程退出，
+    // 避免在静态析构（Windows 下为 DLL 卸载）阶段 join 线程
+    static WorkerPool *pool = new WorkerPool(std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return *pool;
+  }
+
+  WorkerPool::WorkerPool(size_t workers) : m_workerCount(workers) {}
+
+  WorkerPool::~WorkerPool() {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_stopping = true;
+      ++m_generation;
+    }
+    m_wake.notify_all();
+    for (auto &thread: m_threads) {
+      thread.join();
+    }
+  }
+
+  void WorkerPool::run(size_t tasks, const std::function<void(size_t)> &task) {
+    std::unique_lock<std::mutex> runLock(m_runMutex, std::try_to_lock);
+    if (!runLock.owns_lock() || m_workerCount == 0 || tasks <= 1) {
+      for (size_t i = 0; i < tasks; ++i) {
+        task(i);
+      }
+      return;
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (m_threads.empty()) {
+        m_threads.reserve(m_workerCount);
+        for (size_t i = 0; i < m_workerCount; ++i) {
+          m_threads.emplace_back([this] { workerLoop(); });
+        }
+      }
+      m_task = &task;
+      m_taskCount = tasks;
+      m_next.store(0, std::memory_order_relaxed);
+      ++m_generation;
+    }
+    m_wake.notify_all();
+
+    drain(task, tasks);
+
+    // 等待已领取任务的工作线程完成；尚未醒来的线程看到 m_task 为空后直接回到等待
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_task = nullptr;
+    m_idle.wait(lock, [this] { return m_active == 0; });
+  }
+
+  void WorkerPool::drain(const std::function<void(size_t)> &task, size_t tasks) {
+    for (size_t i = m_next.fetch_add(1, std::memory_order_relaxed); i < tasks;
+         i = m_next.fetch_add(1, std::memory_order_relaxed)) {
+      task(i);
+    }
+  }
+
+  void WorkerPool::workerLoop() {
+    uint64_t seen = 0;
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (;;) {
+      m_wake.wait(lock, [this, seen] { return m_generation != seen; });
+      seen = m_generation;
+      if (m_stopping) {
+        return;
+      }
+      if (!m_task) {
+        continue;
+      }
+
+      const std::function<void(size_t)> &task = *m_task;
+      const size_t tasks = m_taskCount;
+      ++m_active;
+      lock.unlock();
+      drain(task, tasks);
+      lock.lock();
+      if (--m_active == 0) {
+        m_idle.notify_all();
+      }
+    }
+  }
+} // namespace ProGraphics
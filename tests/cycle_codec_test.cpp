@@ -0,0 +1,139 @@
+﻿// HistoryFormat 压缩编码的误差上界与分格一致性测试，不需要 OpenGL 上下文
+#include "prographics/utils/cycle_codec.h"
+#include "prographics/utils/simd_kernels.h"
+#include "test_support.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace ProGraphics;
+
+namespace {
+  constexpr float kInf = std::numeric_limits<float>::infinity();
+  constexpr float kNaN = std::numeric_limits<float>::quiet_NaN();
+  constexpr int kBins = 100;
+
+  enum class Format { Int16, LogUInt8 };
+
+  const char *formatName(Format format) { return format == Format::Int16 ? "Int16" : "LogUInt8"; }
+
+  std::vector<float> roundTrip(Format format, const std::vector<float> &cycle) {
+    std::vector<float> decoded(cycle.size());
+    if (format == Format::Int16) {
+      std::vector<uint16_t> codes(cycle.size());
+      const CycleCodecParams params = encodeCycleInt16(cycle.data(), cycle.size(), codes.data());
+      decodeCycleInt16(codes.data(), codes.size(), params, decoded.data());
+    } else {
+      std::vector<uint8_t> codes(cycle.size());
+      const CycleCodecParams params = encodeCycleLogUInt8(cycle.data(), cycle.size(), codes.data());
+      decodeCycleLogUInt8(codes.data(), codes.size(), params, decoded.data());
+    }
+    return decoded;
+  }
+
+  // 头文件中记录的误差上界，另加浮点运算本身的舍入余量
+  float errorBound(Format format, float x, float lo, float hi) {
+    const float range = hi - lo;
+    const float rounding = 8.0f * std::numeric_limits<float>::epsilon() * std::max({std::abs(lo), std::abs(hi), 1.0f});
+    if (format == Format::Int16) {
+      return range / 131070.0f + rounding;
+    }
+    const float u = range > 0.0f ? (hi - x) / range : 0.0f;
+    return range * (1.0f + 255.0f * u) / 255.0f * (std::pow(256.0f, 1.0f / 510.0f) - 1.0f) * 1.0001f + rounding;
+  }
+
+  void checkCycle(Format format, const std::vector<float> &cycle, const char *label) {
+    float lo = std::numeric_limits<float>::max();
+    float hi = std::numeric_limits<float>::lowest();
+    for (float x: cycle) {
+      if (std::isfinite(x)) {
+        lo = std::min(lo, x);
+        hi = std::max(hi, x);
+      }
+    }
+    if (lo > hi) {
+      lo = hi = 0.0f;
+    }
+
+    const std::vector<float> decoded = roundTrip(format, cycle);
+
+    // 分格与 Float32 路径对比：量程取周期自身范围外扩一些，覆盖两端的夹取
+    const float margin = std::max((hi - lo) * 0.05f, 1.0f);
+    const float binMin = lo - margin;
+    const float binMax = hi + margin;
+    const float binWidth = (binMax - binMin) / kBins;
+    std::vector<uint16_t> expectedBins(cycle.size());
+    std::vector<uint16_t> decodedBins(cycle.size());
+    binAmplitudes(cycle.data(), expectedBins.data(), cycle.size(), binMin, binMax, kBins);
+    binAmplitudes(decoded.data(), decodedBins.data(), cycle.size(), binMin, binMax, kBins);
+
+    for (size_t i = 0; i < cycle.size(); ++i) {
+      const float x = cycle[i];
+      const float y = decoded[i];
+      CHECK(std::isfinite(y), "%s %s[%zu]: decoded %g is not finite", formatName(format), label, i, y);
+
+      if (std::isnan(x) || x == -kInf) {
+        CHECK(std::abs(y - lo) <= errorBound(format, lo, lo, hi), "%s %s[%zu]: %g decoded to %g, expected cycle min %g",
+              formatName(format), label, i, x, y, lo);
+        continue;
+      }
+      if (x == kInf) {
+        CHECK(std::abs(y - hi) <= errorBound(format, hi, lo, hi), "%s %s[%zu]: +inf decoded to %g, expected cycle max %g",
+              formatName(format), label, i, y, hi);
+        continue;
+      }
+
+      const float bound = errorBound(format, x, lo, hi);
+      CHECK(std::abs(y - x) <= bound, "%s %s[%zu]: |%g - %g| exceeds bound %g", formatName(format), label, i, y, x, bound);
+
+      // 分格不同只允许发生在格子边界附近，且只差一格
+      if (expectedBins[i] != decodedBins[i]) {
+        const float edge = binMin + std::round((x - binMin) / binWidth) * binWidth;
+        CHECK(std::abs(static_cast<int>(expectedBins[i]) - static_cast<int>(decodedBins[i])) == 1 &&
+              std::abs(x - edge) <= bound,
+              "%s %s[%zu]: bin %d vs float bin %d for %g", formatName(format), label, i, decodedBins[i],
+              expectedBins[i], x);
+      }
+    }
+  }
+} // namespace
+
+int main() {
+  std::mt19937 rng(20241016);
+  constexpr size_t kPoints = 200;
+
+  for (Format format: {Format::Int16, Format::LogUInt8}) {
+    // 随机周期：不同的偏移与幅度，含稀疏的放电尖峰
+    for (int trial = 0; trial < 500; ++trial) {
+      std::uniform_real_distribution<float> offsetDist(-1000.0f, 1000.0f);
+      std::uniform_real_distribution<float> spanDist(1e-3f, 2000.0f);
+      const float offset = offsetDist(rng);
+      const float span = spanDist(rng);
+      std::uniform_real_distribution<float> sample(offset, offset + span);
+      std::bernoulli_distribution spike(0.05);
+      std::vector<float> cycle(kPoints);
+      for (float &x: cycle) {
+        x = spike(rng) ? offset + span * 4.0f : sample(rng);
+      }
+      checkCycle(format, cycle, "random");
+    }
+
+    // 退化周期：全部相等、只有一个有限值、没有有限值
+    checkCycle(format, std::vector<float>(kPoints, 42.5f), "constant");
+    checkCycle(format, {3.0f, kInf, -kInf, kNaN, kInf}, "single-finite");
+    checkCycle(format, {kNaN, kInf, -kInf}, "no-finite");
+    checkCycle(format, {}, "empty");
+
+    // 带非有限值的随机周期
+    std::uniform_real_distribution<float> sample(-50.0f, 50.0f);
+    std::vector<float> mixed(kPoints);
+    for (size_t i = 0; i < kPoints; ++i) {
+      mixed[i] = i % 17 == 0 ? kInf : i % 19 == 0 ? -kInf : i % 23 == 0 ? kNaN : sample(rng);
+    }
+    checkCycle(format, mixed, "mixed-non-finite");
+  }
+
+  return Test::finish("cycle codec");
+}
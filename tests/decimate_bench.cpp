@@ -0,0 +1,79 @@
+﻿// decimateMinMax 基准：200…8192 个相位点上对比标量路径与向量化内核，并校验两者输出逐位一致
+#include "prographics/utils/simd_kernels.h"
+#include "test_support.h"
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <random>
+#include <vector>
+
+using namespace ProGraphics;
+
+namespace {
+  struct Output {
+    std::vector<float> min;
+    std::vector<float> max;
+    std::vector<uint32_t> argMax;
+
+    explicit Output(size_t buckets) : min(buckets), max(buckets), argMax(buckets) {}
+  };
+
+  // 量化到 1/8 的随机幅值，制造大量相等的最大值以检验“同值取最先出现”；偶尔插入 NaN
+  std::vector<float> makeCycle(std::mt19937 &rng, size_t points) {
+    std::uniform_int_distribution<int> level(-80, 400);
+    std::bernoulli_distribution nan(0.01);
+    std::vector<float> cycle(points);
+    for (float &x: cycle) {
+      x = nan(rng) ? std::numeric_limits<float>::quiet_NaN() : static_cast<float>(level(rng)) / 8.0f;
+    }
+    return cycle;
+  }
+
+  void checkEqual(const std::vector<float> &cycle, size_t buckets) {
+    Output scalar(buckets);
+    Output simd(buckets);
+    decimateMinMaxScalar(cycle.data(), cycle.size(), buckets, scalar.min.data(), scalar.max.data(),
+                         scalar.argMax.data());
+    decimateMinMax(cycle.data(), cycle.size(), buckets, simd.min.data(), simd.max.data(), simd.argMax.data());
+
+    const size_t floatBytes = buckets * sizeof(float);
+    CHECK(std::memcmp(scalar.min.data(), simd.min.data(), floatBytes) == 0, "N=%zu B=%zu: bucket minima differ",
+          cycle.size(), buckets);
+    CHECK(std::memcmp(scalar.max.data(), simd.max.data(), floatBytes) == 0, "N=%zu B=%zu: bucket maxima differ",
+          cycle.size(), buckets);
+    CHECK(scalar.argMax == simd.argMax, "N=%zu B=%zu: bucket argmax differs", cycle.size(), buckets);
+  }
+} // namespace
+
+int main() {
+  std::mt19937 rng(18);
+  const size_t pointCounts[] = {200, 256, 512, 1000, 1024, 2048, 4096, 8192};
+
+  // 正确性：包括每桶 1 个点、不能整除的桶数和整周期单桶
+  for (size_t points: pointCounts) {
+    for (int trial = 0; trial < 20; ++trial) {
+      const std::vector<float> cycle = makeCycle(rng, points);
+      for (size_t buckets: {size_t{1}, size_t{7}, points / 40, points / 3, points}) {
+        checkEqual(cycle, buckets);
+      }
+    }
+  }
+
+  // 计时：PRPS 默认每 40 个相位点一根线
+  std::printf("decimateMinMax, isa = %s, buckets = N / 40\n", simdKernelIsa());
+  std::printf("%8s %14s %14s %9s\n", "N", "scalar (ns)", "simd (ns)", "speedup");
+  for (size_t points: pointCounts) {
+    const std::vector<float> cycle = makeCycle(rng, points);
+    const size_t buckets = points / 40;
+    Output out(buckets);
+    const double scalarNs = Test::nanosecondsPerCall([&] {
+      decimateMinMaxScalar(cycle.data(), points, buckets, out.min.data(), out.max.data(), out.argMax.data());
+    });
+    const double simdNs = Test::nanosecondsPerCall([&] {
+      decimateMinMax(cycle.data(), points, buckets, out.min.data(), out.max.data(), out.argMax.data());
+    });
+    std::printf("%8zu %14.1f %14.1f %8.2fx\n", points, scalarNs, simdNs, scalarNs / simdNs);
+  }
+
+  return Test::finish("decimate bench");
+}
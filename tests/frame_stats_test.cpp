@@ -0,0 +1,118 @@
+﻿// BaseGLWidget::lastFrameStats 测试：预留一次、每帧多次上传的 StreamingBuffer 在预热后不再重新分配。
+// 控件在 offscreen 平台上通过 grabFramebuffer() 同步绘制；没有可用的 OpenGL 4.1 驱动时跳过
+#include "prographics/charts/base/gl_widget.h"
+#include "gl_test_context.h"
+#include "test_support.h"
+#include <QApplication>
+#include <vector>
+
+using namespace ProGraphics;
+
+namespace {
+  /**
+   * @brief 每帧把若干个指定大小的块上传到同一个 StreamingBuffer
+   */
+  class StreamingWidget : public BaseGLWidget {
+  public:
+    explicit StreamingWidget(size_t reserveBytes) : m_reserveBytes(reserveBytes) {
+      setFormat(chartSurfaceFormat());
+      resize(64, 64);
+    }
+
+    ~StreamingWidget() override {
+      makeCurrent();
+      m_buffer.destroy();
+      doneCurrent();
+    }
+
+    bool initialized() const { return m_initialized; }
+
+    /**
+     * @brief 设置下一帧的上传：uploads 次，每次 bytes 字节
+     */
+    void setFrameUploads(size_t uploads, size_t bytes) {
+      m_uploads = uploads;
+      m_bytes = bytes;
+    }
+
+  protected:
+    void initializeGLObjects() override {
+      m_buffer.create();
+      m_buffer.reserve(m_reserveBytes);
+      m_initialized = true;
+    }
+
+    void paintGLObjects() override {
+      const size_t count = m_bytes / sizeof(float);
+      for (size_t i = 0; i < m_uploads; ++i) {
+        float *data = m_buffer.stage<float>(count);
+        for (size_t j = 0; j < count; ++j) {
+          data[j] = static_cast<float>(i + j);
+        }
+        m_buffer.uploadStaged(count * sizeof(float));
+      }
+    }
+
+  private:
+    StreamingBuffer m_buffer;
+    size_t m_reserveBytes;
+    size_t m_uploads = 0;
+    size_t m_bytes = 0;
+    bool m_initialized = false;
+  };
+
+  StreamingBuffer::FrameStats renderFrame(StreamingWidget &widget, size_t uploads, size_t bytes) {
+    widget.setFrameUploads(uploads, bytes);
+    widget.grabFramebuffer();
+    return widget.lastFrameStats();
+  }
+
+  void checkReserveOnce(StreamingWidget &widget) {
+    constexpr size_t kUploads = 8;
+    // 预留发生在 initializeGL，不在任何帧内，第一帧起就不应重新分配
+    for (int frame = 0; frame < 10; ++frame) {
+      const size_t bytes = 4096 + 4096 * static_cast<size_t>(frame % 4);
+      const StreamingBuffer::FrameStats stats = renderFrame(widget, kUploads, bytes);
+      CHECK(stats.reallocations == 0, "frame %d: %zu reallocations within the reserved capacity", frame,
+            stats.reallocations);
+      CHECK(stats.uploads == kUploads, "frame %d: %zu uploads, expected %zu", frame, stats.uploads, kUploads);
+      CHECK(stats.bytesUploaded == kUploads * bytes, "frame %d: %zu bytes uploaded, expected %zu", frame,
+            stats.bytesUploaded, kUploads * bytes);
+    }
+  }
+
+  void checkGrowThenSteady(StreamingWidget &widget) {
+    // 没有预留：第一帧扩容计入统计，之后同样大小的上传不再重新分配
+    StreamingBuffer::FrameStats stats = renderFrame(widget, 4, 256 * 1024);
+    CHECK(stats.reallocations >= 1, "growing upload reported no reallocation");
+    for (int frame = 0; frame < 10; ++frame) {
+      stats = renderFrame(widget, 4, 128 * 1024 + 1024 * static_cast<size_t>(frame));
+      CHECK(stats.reallocations == 0, "frame %d after warm-up: %zu reallocations", frame, stats.reallocations);
+      CHECK(stats.uploads == 4, "frame %d after warm-up: %zu uploads", frame, stats.uploads);
+    }
+
+    // 空帧的统计不残留上一帧的计数
+    stats = renderFrame(widget, 0, 0);
+    CHECK(stats.uploads == 0 && stats.bytesUploaded == 0 && stats.reallocations == 0,
+          "an empty frame reported %zu uploads", stats.uploads);
+  }
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QApplication app(argc, argv);
+
+  StreamingWidget reserved(64 * 1024);
+  StreamingWidget growing(0);
+  reserved.grabFramebuffer();
+  growing.grabFramebuffer();
+  if (!reserved.initialized() || !growing.initialized()) {
+    std::printf("frame_stats_test: no OpenGL 4.1 context available, skipped\n");
+    return Test::kSkipReturnCode;
+  }
+
+  checkReserveOnce(reserved);
+  checkGrowThenSteady(growing);
+  // 另一个控件绘制过之后，统计仍只包含本控件的上传
+  checkReserveOnce(reserved);
+  return Test::finish("frame_stats_test");
+}
@@ -0,0 +1,45 @@
+﻿// 需要 OpenGL 上下文的测试使用的离屏上下文
+#pragma once
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QSurfaceFormat>
+#include <memory>
+
+namespace ProGraphics::Test {
+  /**
+   * @brief 无法创建上下文（没有可用的 OpenGL 驱动）时测试以此退出码跳过
+   */
+  constexpr int kSkipReturnCode = 77;
+
+  /**
+   * @brief 与图表控件相同版本（4.1 core）的离屏上下文，构造后即为当前上下文
+   */
+  class OffscreenContext {
+  public:
+    OffscreenContext() {
+      QSurfaceFormat format;
+      format.setVersion(4, 1);
+      format.setProfile(QSurfaceFormat::CoreProfile);
+
+      m_surface.setFormat(format);
+      m_surface.create();
+      m_context.setFormat(format);
+      m_valid = m_surface.isValid() && m_context.create() && m_context.makeCurrent(&m_surface);
+    }
+
+    ~OffscreenContext() {
+      if (m_valid) {
+        m_context.doneCurrent();
+      }
+    }
+
+    bool isValid() const { return m_valid; }
+
+    QOpenGLContext &context() { return m_context; }
+
+  private:
+    QOffscreenSurface m_surface;
+    QOpenGLContext m_context;
+    bool m_valid = false;
+  };
+} // namespace ProGraphics::Test
@@ -0,0 +1,147 @@
+﻿// GpuBufferAllocator 测试：分配、释放、句柄解析与碎片整理。
+// 不绘制任何内容，只需要离屏上下文（CTest 以 offscreen 平台运行，没有可用驱动时跳过）
+#include "prographics/core/graphics/gpu_buffer_allocator.h"
+#include "gl_test_context.h"
+#include "test_support.h"
+#include <QGuiApplication>
+#include <QOpenGLExtraFunctions>
+#include <cstring>
+#include <vector>
+
+using namespace ProGraphics;
+
+namespace {
+  constexpr size_t kArenaSize = 1 << 20;
+  constexpr size_t kBlockSize = 4096;
+
+  std::vector<unsigned char> readBack(QOpenGLExtraFunctions *gl, const GpuBufferLocation &location, size_t bytes) {
+    std::vector<unsigned char> data(bytes);
+    gl->glBindBuffer(GL_COPY_READ_BUFFER, location.buffer);
+    const void *mapped = gl->glMapBufferRange(GL_COPY_READ_BUFFER, static_cast<GLintptr>(location.offset),
+                                              static_cast<GLsizeiptr>(bytes), GL_MAP_READ_BIT);
+    if (mapped) {
+      std::memcpy(data.data(), mapped, bytes);
+      gl->glUnmapBuffer(GL_COPY_READ_BUFFER);
+    }
+    gl->glBindBuffer(GL_COPY_READ_BUFFER, 0);
+    return data;
+  }
+
+  std::vector<unsigned char> pattern(size_t bytes, unsigned char seed) {
+    std::vector<unsigned char> data(bytes);
+    for (size_t i = 0; i < bytes; ++i) {
+      data[i] = static_cast<unsigned char>(seed + i * 7);
+    }
+    return data;
+  }
+
+  void checkHandles(GpuBufferAllocator &allocator) {
+    const GpuBufferHandle first = allocator.allocate(1000);
+    CHECK(first.isValid(), "allocate returned an empty handle");
+    const GpuBufferLocation location = allocator.location(first);
+    CHECK(location.buffer != 0, "live handle resolved to no buffer");
+    CHECK(location.size == 1000 && location.capacity == 1024, "size %zu / capacity %zu, expected 1000 / 1024",
+          location.size, location.capacity);
+
+    const size_t live = allocator.stats().liveAllocations;
+    allocator.release(first);
+    CHECK(allocator.location(first).buffer == 0, "released handle still resolves");
+    CHECK(allocator.stats().liveAllocations == live - 1, "release did not drop the live count");
+    CHECK(allocator.stats().freeBytes >= 1024, "released block is not on a free list");
+    allocator.release(first);
+    CHECK(allocator.stats().liveAllocations == live - 1, "releasing a stale handle changed the live count");
+
+    // 同级别的新分配复用槽位与块，旧句柄因代数不同仍然无效
+    const GpuBufferHandle second = allocator.allocate(900);
+    CHECK(second.index == first.index && second.generation != first.generation,
+          "slot was not reused with a new generation");
+    CHECK(allocator.location(second).offset == location.offset, "free block of the same class was not reused");
+    CHECK(allocator.location(first).buffer == 0, "stale handle resolves after its slot was reused");
+    allocator.release(second);
+
+    CHECK(allocator.location(GpuBufferHandle{}).buffer == 0, "empty handle resolves");
+    CHECK(allocator.location(GpuBufferHandle{1u << 30, 1}).buffer == 0, "out of range handle resolves");
+
+    const GpuBufferHandle large = allocator.allocate(2 * kArenaSize);
+    CHECK(allocator.stats().dedicatedBuffers == 1, "oversized allocation did not get a dedicated buffer");
+    CHECK(allocator.location(large).capacity == 2 * kArenaSize, "dedicated capacity is %zu",
+          allocator.location(large).capacity);
+    allocator.release(large);
+    CHECK(allocator.stats().dedicatedBuffers == 0, "dedicated buffer survived its release");
+  }
+
+  void checkCompaction(GpuBufferAllocator &allocator, QOpenGLExtraFunctions *gl) {
+    // 填满三个 arena 后只保留每 8 块中的一块
+    constexpr size_t kBlocks = 3 * kArenaSize / kBlockSize;
+    std::vector<GpuBufferHandle> handles(kBlocks);
+    for (size_t i = 0; i < kBlocks; ++i) {
+      handles[i] = allocator.allocate(kBlockSize);
+      const std::vector<unsigned char> data = pattern(kBlockSize, static_cast<unsigned char>(i));
+      allocator.upload(handles[i], data.data(), data.size());
+    }
+    const size_t arenasBefore = allocator.stats().arenas;
+    CHECK(arenasBefore >= 3, "expected at least 3 arenas, got %zu", arenasBefore);
+
+    // 少量空闲块不足以整理
+    const uint64_t epoch = allocator.epoch();
+    allocator.release(handles[1]);
+    CHECK(allocator.maintain() == 0 && allocator.epoch() == epoch, "maintain compacted a barely fragmented heap");
+
+    std::vector<size_t> kept;
+    for (size_t i = 0; i < kBlocks; ++i) {
+      if (i % 8 == 0) {
+        kept.push_back(i);
+      } else {
+        allocator.release(handles[i]);
+      }
+    }
+    const GpuBufferAllocator::Stats fragmented = allocator.stats();
+    CHECK(fragmented.freeBytes >= 2 * kArenaSize, "free bytes %zu after releasing 7/8 of the blocks",
+          fragmented.freeBytes);
+
+    const size_t reclaimed = allocator.maintain();
+    const GpuBufferAllocator::Stats compacted = allocator.stats();
+    CHECK(reclaimed >= 2 * kArenaSize, "maintain reclaimed %zu bytes", reclaimed);
+    CHECK(allocator.epoch() == epoch + 1, "compaction did not advance the epoch");
+    CHECK(compacted.arenas < arenasBefore, "arena count %zu -> %zu", arenasBefore, compacted.arenas);
+    CHECK(compacted.liveAllocations == fragmented.liveAllocations, "compaction changed the live count");
+    CHECK(compacted.reservedBytes == fragmented.reservedBytes - reclaimed, "reserved bytes do not match reclaim");
+    CHECK(allocator.maintain() == 0, "a compacted heap was compacted again");
+
+    // 存活句柄解析到新位置，数据完整
+    for (size_t i: kept) {
+      const GpuBufferLocation location = allocator.location(handles[i]);
+      CHECK(location.buffer != 0, "handle %zu lost its block", i);
+      if (location.buffer == 0) {
+        continue;
+      }
+      CHECK(readBack(gl, location, kBlockSize) == pattern(kBlockSize, static_cast<unsigned char>(i)),
+            "block %zu changed during compaction", i);
+    }
+    for (size_t i = 0; i < kBlocks; i += 3) {
+      if (i % 8 != 0) {
+        CHECK(allocator.location(handles[i]).buffer == 0, "released handle %zu resolves after compaction", i);
+      }
+    }
+
+    for (size_t i: kept) {
+      allocator.release(handles[i]);
+    }
+  }
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QGuiApplication app(argc, argv);
+  Test::OffscreenContext context;
+  if (!context.isValid()) {
+    std::printf("gpu_buffer_allocator_test: no OpenGL 4.1 context available, skipped\n");
+    return Test::kSkipReturnCode;
+  }
+
+  auto &allocator = GpuBufferAllocator::getInstance();
+  checkHandles(allocator);
+  checkCompaction(allocator, context.context().extraFunctions());
+  allocator.cleanup();
+  CHECK(allocator.stats().reservedBytes == 0, "cleanup left %zu bytes reserved", allocator.stats().reservedBytes);
+  return Test::finish("gpu_buffer_allocator_test");
+}
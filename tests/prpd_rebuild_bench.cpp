@@ -0,0 +1,135 @@
+﻿// PRPD 频次表重建延迟基准：串行、每次调用创建线程与常驻线程池三种执行方式的对比
+#include "prographics/charts/prpd/prpd.h"
+#include "prographics/utils/simd_kernels.h"
+#include "prographics/utils/worker_pool.h"
+#include "test_support.h"
+#include <algorithm>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace ProGraphics;
+
+namespace {
+  constexpr float kMin = 0.0f;
+  constexpr float kMax = 100.0f;
+
+  // 一个 Float32 历史环与对应的频次表，重建方式与 PRPDChart::rebuildFrequencyTable 相同：
+  // 按相位列切分，每段逐周期分格并计入自己的相位行
+  struct RebuildGrid {
+    int points;
+    int cycles;
+    int bins = PRPDConstants::AMPLITUDE_BINS;
+    std::vector<float> history;
+    std::vector<uint16_t> binIndices;
+    std::vector<int> table;
+
+    RebuildGrid(int points, int cycles, std::mt19937 &rng)
+      : points(points), cycles(cycles), history(static_cast<size_t>(points) * cycles),
+        binIndices(history.size()), table(static_cast<size_t>(points) * PRPDConstants::AMPLITUDE_BINS) {
+      std::uniform_real_distribution<float> amplitude(kMin - 5.0f, kMax + 5.0f);
+      for (float &x: history) {
+        x = amplitude(rng);
+      }
+    }
+
+    size_t grain() const { return PRPDConstants::PARALLEL_REBUILD_GRAIN / std::max(cycles, 1) + 1; }
+
+    void rebuildColumns(size_t begin, size_t end) {
+      const size_t width = end - begin;
+      for (int c = 0; c < cycles; ++c) {
+        const size_t row = static_cast<size_t>(c) * points;
+        uint16_t *out = binIndices.data() + row + begin;
+        binAmplitudes(history.data() + row + begin, out, width, kMin, kMax, bins);
+        for (size_t k = 0; k < width; ++k) {
+          ++table[(begin + k) * bins + out[k]];
+        }
+      }
+    }
+
+    void clear() { std::fill(table.begin(), table.end(), 0); }
+  };
+
+  // 线程池引入之前的实现：每次调用创建并 join 工作线程
+  template<typename Fn>
+  void spawningParallelFor(size_t count, size_t minChunk, Fn &&fn) {
+    const size_t hardware = std::max(1u, std::thread::hardware_concurrency());
+    const size_t chunks = std::min(hardware, count / std::max<size_t>(minChunk, 1));
+    if (chunks <= 1) {
+      fn(size_t{0}, count);
+      return;
+    }
+    std::vector<std::thread> workers;
+    workers.reserve(chunks - 1);
+    for (size_t c = 1; c < chunks; ++c) {
+      workers.emplace_back([&fn, c, chunks, count] { fn(c * count / chunks, (c + 1) * count / chunks); });
+    }
+    fn(size_t{0}, count / chunks);
+    for (auto &worker: workers) {
+      worker.join();
+    }
+  }
+} // namespace
+
+int main() {
+  std::mt19937 rng(7);
+
+  // 调度开销：4 个空任务，独立线程池（3 个工作线程）对比每次创建 3 个线程
+  {
+    WorkerPool pool(3);
+    const auto noop = [](size_t) {};
+    const double pooledNs = Test::nanosecondsPerCall([&] { pool.run(4, noop); });
+    const double spawnNs = Test::nanosecondsPerCall([&] {
+      std::vector<std::thread> workers;
+      for (int i = 0; i < 3; ++i) {
+        workers.emplace_back([] {});
+      }
+      for (auto &worker: workers) {
+        worker.join();
+      }
+    });
+    std::printf("dispatch of 4 empty tasks: pool %.1f us, spawn+join %.1f us\n", pooledNs / 1000.0,
+                spawnNs / 1000.0);
+  }
+
+  // 正确性：线程池上的分段重建与串行重建的频次表一致（固定 4 段，单核机器上同样走线程池路径）
+  {
+    WorkerPool pool(3);
+    for (int points: {200, 1000, 8192}) {
+      RebuildGrid grid(points, 64, rng);
+      grid.rebuildColumns(0, static_cast<size_t>(points));
+      const std::vector<int> serial = grid.table;
+      grid.clear();
+      parallelFor(pool, static_cast<size_t>(points), static_cast<size_t>(points) / 4,
+                  [&grid](size_t begin, size_t end) { grid.rebuildColumns(begin, end); });
+      CHECK(grid.table == serial, "N=%d: pooled rebuild differs from serial rebuild", points);
+    }
+  }
+
+  // 重建延迟：与 rebuildFrequencyTable 相同的分段粒度（每段至少 PARALLEL_REBUILD_GRAIN 个样本）
+  std::printf("rebuildFrequencyTable, isa = %s, hardware threads = %u, grain = %zu samples\n", simdKernelIsa(),
+              std::max(1u, std::thread::hardware_concurrency()), PRPDConstants::PARALLEL_REBUILD_GRAIN);
+  std::printf("%6s %7s %10s %12s %12s %12s\n", "N", "cycles", "samples", "serial (us)", "spawn (us)", "pool (us)");
+  const int grids[][2] = {{200, 100}, {200, 500}, {1024, 500}, {200, 5000}, {8192, 500}};
+  for (const auto &size: grids) {
+    RebuildGrid grid(size[0], size[1], rng);
+    const size_t points = static_cast<size_t>(grid.points);
+    const auto rebuild = [&grid](size_t begin, size_t end) { grid.rebuildColumns(begin, end); };
+    const double serialNs = Test::nanosecondsPerCall([&] {
+      grid.clear();
+      grid.rebuildColumns(0, points);
+    }, 3);
+    const double spawnNs = Test::nanosecondsPerCall([&] {
+      grid.clear();
+      spawningParallelFor(points, grid.grain(), rebuild);
+    }, 3);
+    const double poolNs = Test::nanosecondsPerCall([&] {
+      grid.clear();
+      parallelFor(points, grid.grain(), rebuild);
+    }, 3);
+    std::printf("%6d %7d %10zu %12.1f %12.1f %12.1f\n", grid.points, grid.cycles, grid.history.size(),
+                serialNs / 1000.0, spawnNs / 1000.0, poolNs / 1000.0);
+  }
+
+  return Test::finish("prpd rebuild bench");
+}
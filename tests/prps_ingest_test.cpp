@@ -0,0 +1,81 @@
+﻿// PRPS 数据接入测试：setPhasePoint 的参数校验与 addCycles 的单周期开销。
+// 只构造控件、不显示，不需要 OpenGL 上下文（CTest 以 offscreen 平台运行）
+#include "prographics/charts/prps/prps.h"
+#include "test_support.h"
+#include <QApplication>
+#include <random>
+#include <vector>
+
+using namespace ProGraphics;
+
+namespace {
+  // 开销上界只在优化构建中检查，未优化的调试构建只打印结果
+#ifdef NDEBUG
+  constexpr bool kEnforceTiming = true;
+#else
+  constexpr bool kEnforceTiming = false;
+#endif
+  constexpr double kMaxNanosecondsPerCycle = 1000.0;
+
+  std::vector<float> makeCycles(size_t cycles, int points) {
+    std::mt19937 rng(20);
+    std::uniform_real_distribution<float> amplitude(-75.0f, -30.0f);
+    std::vector<float> data(cycles * static_cast<size_t>(points));
+    for (float &x: data) {
+      x = amplitude(rng);
+    }
+    return data;
+  }
+
+  void checkSetPhasePoint() {
+    PRPSChart chart;
+    const int points = chart.getPhasePoint();
+    const std::vector<float> data = makeCycles(10, points);
+    chart.addCycles(data);
+    const size_t history = chart.historySize();
+    CHECK(history > 0, "addCycles stored no history");
+
+    for (int invalid: {0, -1, -200}) {
+      chart.setPhasePoint(invalid);
+      CHECK(chart.getPhasePoint() == points, "setPhasePoint(%d) changed the point count to %d", invalid,
+            chart.getPhasePoint());
+      CHECK(chart.historySize() == history, "setPhasePoint(%d) cleared the history", invalid);
+    }
+
+    chart.setPhasePoint(points);
+    CHECK(chart.historySize() == history, "setPhasePoint with the current value cleared the history");
+
+    chart.setPhasePoint(points * 2);
+    CHECK(chart.getPhasePoint() == points * 2, "setPhasePoint(%d) was not applied", points * 2);
+    CHECK(chart.historySize() == 0, "history of the old length survived a point count change");
+    const std::vector<float> wider = makeCycles(4, points * 2);
+    chart.addCycles(wider);
+    CHECK(chart.historySize() > 0, "addCycles with the new point count stored no history");
+  }
+
+  void checkIngestionCost() {
+    PRPSChart chart;
+    const int points = chart.getPhasePoint();
+    constexpr size_t kBlock = 1000;
+    const std::vector<float> data = makeCycles(kBlock, points);
+
+    for (int cyclesPerGroup: {1, 50}) {
+      chart.setCyclesPerGroup(cyclesPerGroup);
+      const double blockNs = Test::nanosecondsPerCall([&] { chart.addCycles(data); });
+      const double perCycle = blockNs / static_cast<double>(kBlock);
+      std::printf("addCycles: %d phase points, %d cycle(s) per group: %.1f ns per cycle\n", points,
+                  cyclesPerGroup, perCycle);
+      if (kEnforceTiming) {
+        CHECK(perCycle < kMaxNanosecondsPerCycle, "ingestion costs %.1f ns per cycle, expected < %.0f ns", perCycle,
+              kMaxNanosecondsPerCycle);
+      }
+    }
+  }
+} // namespace
+
+int main(int argc, char *argv[]) {
+  QApplication app(argc, argv);
+  checkSetPhasePoint();
+  checkIngestionCost();
+  return Test::finish("prps ingest");
+}
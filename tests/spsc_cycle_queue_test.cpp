@@ -0,0 +1,130 @@
+﻿// SpscCycleQueue 测试：Block 策略的等待上限，以及生产者与 reset() 并发时的握手。
+// 只依赖头文件，不需要 Qt 或 OpenGL 上下文
+#include "prographics/utils/spsc_cycle_queue.h"
+#include "test_support.h"
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+using namespace ProGraphics;
+
+namespace {
+  constexpr size_t kCycleSize = 64;
+
+  void checkBlockTimeout() {
+    SpscCycleQueue queue(4, kCycleSize);
+    queue.setOverflowPolicy(OverflowPolicy::Block);
+    queue.setBlockTimeout(std::chrono::milliseconds(20));
+    const std::vector<float> cycle(kCycleSize, 1.0f);
+    for (int i = 0; i < 4; ++i) {
+      CHECK(queue.push(cycle.data(), cycle.size()), "push %d into a non-full queue failed", i);
+    }
+
+    // 没有消费者：等待到上限后丢弃，而不是一直等下去
+    const auto start = std::chrono::steady_clock::now();
+    const bool pushed = queue.push(cycle.data(), cycle.size());
+    const auto waited = std::chrono::steady_clock::now() - start;
+    CHECK(!pushed, "push into a full queue without a consumer succeeded");
+    CHECK(queue.droppedCount() == 1, "timed out push counted %llu drops",
+          static_cast<unsigned long long>(queue.droppedCount()));
+    CHECK(waited >= std::chrono::milliseconds(20), "push gave up before the timeout");
+    CHECK(waited < std::chrono::seconds(2), "push waited far beyond the timeout");
+
+    // 消费者在等待期间腾出空间时写入成功
+    queue.setBlockTimeout(std::chrono::seconds(5));
+    std::thread consumer([&queue] {
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+      std::vector<float> out;
+      queue.popAll(out);
+    });
+    CHECK(queue.push(cycle.data(), cycle.size()), "blocked push did not resume after the consumer drained");
+    consumer.join();
+    CHECK(queue.droppedCount() == 1, "resumed push was counted as dropped");
+  }
+
+  /**
+   * @brief 生产者持续写入，消费者交替取数据与 reset() 改变容量
+   *
+   * 每个周期的所有元素都等于其序号：取出的周期必须完整（没有写了一半的槽位）且序号严格递增。
+   */
+  void checkResetHandshake(OverflowPolicy policy) {
+    SpscCycleQueue queue(8, kCycleSize);
+    queue.setOverflowPolicy(policy);
+    queue.setBlockTimeout(std::chrono::milliseconds(1));
+
+    // 生产者定时让出 CPU，单核机器上两侧也能交替运行
+    constexpr auto kDuration = std::chrono::milliseconds(150);
+    std::atomic<bool> done{false};
+    std::atomic<size_t> accepted{0};
+    std::atomic<size_t> submitted{0};
+    std::thread producer([&] {
+      std::vector<float> cycle(kCycleSize);
+      const auto end = std::chrono::steady_clock::now() + kDuration;
+      for (size_t seq = 1; std::chrono::steady_clock::now() < end; ++seq) {
+        std::fill(cycle.begin(), cycle.end(), static_cast<float>(seq));
+        if (queue.push(cycle.data(), cycle.size())) {
+          accepted.fetch_add(1, std::memory_order_relaxed);
+        }
+        submitted.store(seq, std::memory_order_relaxed);
+        if (seq % 16 == 0) {
+          std::this_thread::yield();
+        }
+      }
+      done.store(true, std::memory_order_release);
+    });
+
+    std::vector<float> out;
+    float lastSeq = 0.0f;
+    size_t torn = 0;
+    size_t outOfOrder = 0;
+    size_t popped = 0;
+    size_t resets = 0;
+    auto nextReset = std::chrono::steady_clock::now();
+    for (size_t round = 0; !done.load(std::memory_order_acquire); ++round) {
+      out.clear();
+      popped += queue.popAll(out);
+      for (size_t offset = 0; offset < out.size(); offset += kCycleSize) {
+        const float seq = out[offset];
+        for (size_t i = 1; i < kCycleSize; ++i) {
+          if (out[offset + i] != seq) {
+            ++torn;
+            break;
+          }
+        }
+        if (seq <= lastSeq) {
+          ++outOfOrder;
+        }
+        lastSeq = seq;
+      }
+      // 每 200 µs 重新分配一次，其余时间正常取数据
+      if (std::chrono::steady_clock::now() >= nextReset) {
+        queue.reset(4 + round % 13, kCycleSize);
+        ++resets;
+        nextReset = std::chrono::steady_clock::now() + std::chrono::microseconds(200);
+      }
+    }
+    producer.join();
+    out.clear();
+    popped += queue.popAll(out);
+
+    const char *name = policy == OverflowPolicy::Block ? "Block" : policy == OverflowPolicy::DropOldest
+                                                                     ? "DropOldest"
+                                                                     : "DropNewest";
+    CHECK(torn == 0, "%s: %zu torn cycles", name, torn);
+    CHECK(outOfOrder == 0, "%s: %zu cycles out of order", name, outOfOrder);
+    CHECK(popped <= accepted.load(), "%s: popped %zu of %zu accepted cycles", name, popped, accepted.load());
+    CHECK(popped > 0, "%s: consumer received nothing", name);
+    CHECK(resets > 1, "%s: the producer finished before any concurrent reset", name);
+    std::printf("%-10s accepted %zu / %zu, popped %zu, %zu resets\n", name, accepted.load(), submitted.load(), popped,
+                resets);
+  }
+} // namespace
+
+int main() {
+  checkBlockTimeout();
+  for (OverflowPolicy policy: {OverflowPolicy::DropOldest, OverflowPolicy::DropNewest, OverflowPolicy::Block}) {
+    checkResetHandshake(policy);
+  }
+  return Test::finish("spsc_cycle_queue_test");
+}
@@ -0,0 +1,58 @@
+﻿// 测试与基准共用的检查宏和计时工具
+#pragma once
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+
+namespace ProGraphics::Test {
+  inline int &failureCount() {
+    static int failures = 0;
+    return failures;
+  }
+
+  /**
+   * @brief 汇总检查结果作为 main 的返回值
+   */
+  inline int finish(const char *name) {
+    if (failureCount() != 0) {
+      std::fprintf(stderr, "%s: %d check(s) failed\n", name, failureCount());
+      return EXIT_FAILURE;
+    }
+    std::printf("%s: all checks passed\n", name);
+    return EXIT_SUCCESS;
+  }
+
+  /**
+   * @brief 单次调用的耗时（纳秒）：每轮连续执行至少 minDuration，取多轮中的最小值以压低调度噪声
+   */
+  template<typename Fn>
+  double nanosecondsPerCall(Fn &&fn, int rounds = 5,
+                            std::chrono::nanoseconds minDuration = std::chrono::milliseconds(10)) {
+    using Clock = std::chrono::steady_clock;
+    double best = 0.0;
+    for (int round = 0; round < rounds; ++round) {
+      size_t calls = 0;
+      const auto start = Clock::now();
+      auto elapsed = Clock::duration::zero();
+      do {
+        fn();
+        ++calls;
+        elapsed = Clock::now() - start;
+      } while (elapsed < minDuration);
+      const double perCall = std::chrono::duration<double, std::nano>(elapsed).count() / static_cast<double>(calls);
+      best = round == 0 ? perCall : std::min(best, perCall);
+    }
+    return best;
+  }
+} // namespace ProGraphics::Test
+
+#define CHECK(cond, ...)                                                              \
+  do {                                                                                \
+    if (!(cond)) {                                                                    \
+      ++ProGraphics::Test::failureCount();                                            \
+      std::fprintf(stderr, "%s:%d: CHECK(%s) failed: ", __FILE__, __LINE__, #cond);   \
+      std::fprintf(stderr, __VA_ARGS__);                                              \
+      std::fprintf(stderr, "\n");                                                     \
+    }                                                                                 \
+  } while (0)